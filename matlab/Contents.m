@@ -24,7 +24,15 @@
 % shGetSubPop               Extract the responses of all the neurons with similar tuning from shModel output
 % shMkV1Filter              Make the linear filter that is the front end of a given model V1 neuron.
 % shModel                   Run the Simoncelli & Heeger model
+% shModelAtPositions        Run the model only for neurons at given spatial positions.
+% shModelPlan               Predict the peak memory and run time of the model, and size chunks to fit.
+% shModelTiled              Run the model on a large stimulus in parallel spatial tiles.
 % shMtPopulationResponse    Compute the response of a large population of MT neurons to a stimulus.
+% shMtVelocityField         Compute MT responses for a dense set of velocities from one V1 pass.
+% shOnlineInit              Set up the model for online, frame-by-frame computation.
+% shOnlinePush              Push the next frame of a stimulus through an online model engine.
+% shSessionInit             Set up a model session that recomputes only what has changed.
+% shSessionRun              Run the model for a session, rerunning only the affected stages.
 % shV1PopulationResponse    Compute the response of a large population of V1 neurons to a stimulus.
 % v12sin                    Get the paramters of the drifting grating preferred by given V1 neurons.
 %
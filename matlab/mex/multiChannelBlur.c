@@ -0,0 +1,152 @@
+/*
+ * multiChannelBlur.c
+ *
+ * This MEX function blurs every channel (column) and every scale of a
+ * response matrix with a separable 3D filter in one call, and returns the
+ * valid part of the result laid out as a response matrix. It is the one
+ * entry point for blurring responses: each (channel, scale) volume is read
+ * and written through strided views (see shView.h), and the frames of all the
+ * output volumes are independent tasks spread over the available cores
+ * (see shParallel.h). Their scratch space is kept between calls (see
+ * shArena.h), and the output is not zero-filled before it is written.
+ *
+ * Usage in MATLAB:
+ *   mex multiChannelBlur.c                   % Compile the MEX function
+ *   res = multiChannelBlur(pop, popInd, spatialFilter, temporalFilter)
+ *
+ * Inputs:
+ *   - pop:            A real, non-sparse, double-precision response matrix,
+ *                     positions x channels.
+ *   - popInd:         The index matrix of pop.
+ *   - spatialFilter:  The 1D filter applied along the first two
+ *                     dimensions.
+ *   - temporalFilter: The 1D filter applied along the third dimension.
+ *
+ * Output:
+ *   - res:    The blurred responses. Their index matrix is
+ *             shTrimIndices(popInd, zeros([fsz fsz ftsz])), where fsz and
+ *             ftsz are the lengths of the filters.
+ *
+ * Notes:
+ *   - shGaussianBlur is the MATLAB interface; call it rather than this
+ *     function.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include "shParallel.h"
+#include "shView.h"
+#include "shArena.h"
+
+/* Macro to check if the input is a valid double matrix */
+#define notDblMtx(matrix) (!mxIsNumeric(matrix) || !mxIsDouble(matrix) || mxIsSparse(matrix) || mxIsComplex(matrix))
+
+typedef struct {
+    const double *in, *ind, *fs, *ft;
+    double *out, *outInd;
+    size_t nIn, nOut, nCols, nIndRows, nfs, nft, framesPerColumn;
+    size_t *frameStart;     /* per scale */
+    double *scratch;        /* one slot of slotSize doubles per thread */
+    size_t slotSize;
+} mcb_context;
+
+/* Blur one output frame of one scale of one channel */
+static void mcb_frame(size_t task, void *vctx)
+{
+    mcb_context *ctx = (mcb_context *)vctx;
+    size_t col = task / ctx->framesPerColumn;
+    size_t f = task % ctx->framesPerColumn;
+    size_t s = 0, t;
+    sh_view in, out;
+
+    while (f >= ctx->frameStart[s + 1])
+        s++;
+    t = f - ctx->frameStart[s];
+
+    /* both index matrices were checked in mexFunction */
+    if (sh_subpop_view(&in, (double *)ctx->in, ctx->nIn, ctx->nCols, ctx->ind, ctx->nIndRows, col, s) != 0 ||
+        sh_subpop_view(&out, ctx->out, ctx->nOut, ctx->nCols, ctx->outInd, ctx->nIndRows, col, s) != 0)
+        return;
+
+    sh_view_blur(&in, &out, ctx->fs, ctx->nfs, ctx->fs, ctx->nfs, ctx->ft, ctx->nft,
+                 t, t + 1, ctx->scratch + sh_thread_id() * ctx->slotSize);
+}
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    mcb_context ctx;
+    const double *ind;
+    size_t i, s, nRows, nScales;
+
+    /* Input validation */
+    if (nrhs != 4) {
+        mexErrMsgTxt("This function requires exactly 4 input arguments.");
+    }
+    for (i = 0; i < 4; i++) {
+        if (notDblMtx(prhs[i])) {
+            mexErrMsgTxt("All inputs must be real, non-sparse, double-precision matrices.");
+        }
+    }
+    if (mxGetN(prhs[1]) != 4 || mxGetM(prhs[1]) < 2) {
+        mexErrMsgTxt("POPIND must be an (nScales+1) x 4 index matrix.");
+    }
+
+    ind = mxGetPr(prhs[1]);
+    nRows = mxGetM(prhs[1]);
+    nScales = nRows - 1;
+    ctx.nIn = mxGetM(prhs[0]);
+    ctx.nCols = mxGetN(prhs[0]);
+    if (sh_check_ind(ind, nRows, ctx.nIn) != 0) {
+        mexErrMsgTxt("POPIND does not describe the rows of POP.");
+    }
+
+    ctx.fs = mxGetPr(prhs[2]);
+    ctx.nfs = mxGetNumberOfElements(prhs[2]);
+    ctx.ft = mxGetPr(prhs[3]);
+    ctx.nft = mxGetNumberOfElements(prhs[3]);
+    if (ctx.nfs == 0 || ctx.nft == 0) {
+        mexErrMsgTxt("The filters must not be empty.");
+    }
+
+    /* the index matrix of the blurred responses, as shTrimIndices computes it */
+    ctx.outInd = (double *)mxMalloc(4 * nRows * sizeof(double));
+    ctx.frameStart = (size_t *)mxMalloc(nRows * sizeof(size_t));
+    ctx.nIndRows = nRows;
+    ctx.nOut = 0;
+    ctx.frameStart[0] = 0;
+    ctx.slotSize = 0;
+    for (s = 0; s < 4; s++)
+        ctx.outInd[s * nRows] = 0;
+    for (s = 0; s < nScales; s++) {
+        size_t Y = (size_t)ind[s + 1 + nRows];
+        size_t X = (size_t)ind[s + 1 + 2 * nRows];
+        size_t T = (size_t)ind[s + 1 + 3 * nRows];
+
+        if (Y < ctx.nfs || X < ctx.nfs || T < ctx.nft) {
+            mexErrMsgTxt("The filters are larger than the response volume.");
+        }
+        ctx.nOut += (Y - ctx.nfs + 1) * (X - ctx.nfs + 1) * (T - ctx.nft + 1);
+        ctx.outInd[s + 1] = (double)ctx.nOut;
+        ctx.outInd[s + 1 + nRows] = (double)(Y - ctx.nfs + 1);
+        ctx.outInd[s + 1 + 2 * nRows] = (double)(X - ctx.nfs + 1);
+        ctx.outInd[s + 1 + 3 * nRows] = (double)(T - ctx.nft + 1);
+        ctx.frameStart[s + 1] = ctx.frameStart[s] + T - ctx.nft + 1;
+        if (Y * X + Y * (X - ctx.nfs + 1) > ctx.slotSize)
+            ctx.slotSize = Y * X + Y * (X - ctx.nfs + 1);   /* sh_view_blur_scratch */
+    }
+    ctx.framesPerColumn = ctx.frameStart[nScales];
+
+    ctx.in = mxGetPr(prhs[0]);
+    ctx.ind = ind;
+    plhs[0] = mxCreateUninitNumericMatrix(ctx.nOut, ctx.nCols, mxDOUBLE_CLASS, mxREAL);
+    ctx.out = mxGetPr(plhs[0]);
+    ctx.scratch = sh_arena_get(sh_thread_count() * ctx.slotSize);
+
+    sh_parallel_for(ctx.nCols * ctx.framesPerColumn, mcb_frame, &ctx);
+
+    mxFree(ctx.outInd);
+    mxFree(ctx.frameStart);
+    return;
+}
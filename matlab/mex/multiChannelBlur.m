@@ -0,0 +1,35 @@
+% RES = multiChannelBlur(POP, POPIND, SPATIALFILTER, TEMPORALFILTER)
+%
+% Blur every channel and scale of the response matrix POP with the
+% separable filter SPATIALFILTER x SPATIALFILTER x TEMPORALFILTER (valid
+% region). Called by shGaussianBlur.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function res = multiChannelBlur(pop, popind, f, ft)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "multiChannelBlur.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+fx = reshape(f, [1 length(f) 1]);
+fy = reshape(f, [length(f) 1 1]);
+ft = reshape(ft, [1 1 length(ft)]);
+
+ind = shTrimIndices(popind, zeros([length(f) length(f) length(ft)]));
+res = zeros(ind(end, 1), size(pop, 2));
+for s = 1:size(popind, 1)-1
+    rows = popind(s, 1)+1:popind(s+1, 1);
+    resRows = ind(s, 1)+1:ind(s+1, 1);
+    for n = 1:size(pop, 2)
+        tmp = reshape(pop(rows, n), popind(s+1, 2:4));
+        tmp = validCorrDn3(tmp, fx);
+        tmp = validCorrDn3(tmp, fy);
+        if ~isequal(ft, 1)
+            tmp = validCorrDn3(tmp, ft);
+        end
+        res(resRows, n) = tmp(:);
+    end
+end
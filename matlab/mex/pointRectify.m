@@ -0,0 +1,27 @@
+% pop = pointRectify(pop, scale)
+% pop = pointRectify(pop, scale, alpha, exponent)
+%
+% Full-wave rectify (square and scale) or, given alpha and exponent,
+% half-wave rectify (add alpha, clip at zero, raise to the exponent and
+% scale) a response matrix. The MEX version does it in one pass over the
+% data, spread over the available cores, without the full-size
+% temporaries and the logical mask of the expressions below.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function pop = pointRectify(pop, scale, alpha, exponent)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "pointRectify.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+if nargin > 2
+    pop = pop + alpha;
+    pop = (pop>0).*pop.^exponent;
+    pop = pop.*scale;
+else
+    pop = pop.^2;
+    pop = pop * scale;
+end
@@ -0,0 +1,224 @@
+/*
+ * separableDerivatives.c
+ *
+ * This MEX function computes the responses of the separable directional
+ * derivative filters that are the front end of the V1 stage (see
+ * shModelV1Separable), and writes each of them straight into its rows of
+ * the response matrix S. For a derivative of order torder in time, xorder
+ * in X and yorder in Y (torder + xorder + yorder = order), a movie is
+ * filtered with temporal filter torder, spatial filter xorder along X and
+ * spatial filter yorder along Y, as three valid correlations; the temporal
+ * and Y filters are flipped first, as shModelV1Separable always did.
+ *
+ * The work is split into the output frames of every movie. For each frame
+ * the temporal pass of every order is computed once and shared by all the
+ * derivatives of that order, and the last (Y) pass of each derivative is
+ * written through a view of its column of S (see shView.h), so no
+ * per-filter temporary is handed back to MATLAB or copied into S. The
+ * frames are spread over the available cores (see shParallel.h), with
+ * scratch space kept between calls (see shArena.h).
+ *
+ * Usage in MATLAB:
+ *   mex separableDerivatives.c               % Compile the MEX function
+ *   S = separableDerivatives(movies, ind, spatialFilters, temporalFilters)
+ *
+ * Inputs:
+ *   - movies:          A cell array with one real, double-precision
+ *                      [Y X T] movie per scale in ind (for a batch, per
+ *                      scale of every stimulus, see shStackIndices).
+ *   - ind:             The index matrix of S. Row s+1 holds the size of
+ *                      the valid part of movie s.
+ *   - spatialFilters:  An fsz x (order+1) matrix; column k+1 is the
+ *                      spatial filter of derivative order k.
+ *   - temporalFilters: An ftsz x (order+1) matrix of temporal filters.
+ *
+ * Output:
+ *   - S:      The responses, ind(end, 1) x nFilters, where nFilters is
+ *             the number of ways to split order between T, X and Y (10 for
+ *             order 3). The columns go through torder = 0 .. order and,
+ *             within each, xorder = 0 .. order - torder.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include "shParallel.h"
+#include "shView.h"
+#include "shArena.h"
+
+/* Macro to check if the input is a valid double matrix */
+#define notDblMtx(matrix) (!mxIsNumeric(matrix) || !mxIsDouble(matrix) || mxIsSparse(matrix) || mxIsComplex(matrix))
+
+typedef struct {
+    const double **movies;  /* one per block of ind */
+    const double *ind;
+    const double *fs;       /* spatial filters, fsz x nOrders */
+    const double *fsFlip;   /* the same, flipped */
+    const double *ftFlip;   /* temporal filters, flipped */
+    double *S;
+    size_t nRows, nFilters, nIndRows, nfs, nft, nOrders;
+    size_t *frameStart;     /* per block */
+    double *scratch;        /* one slot of slotSize doubles per thread */
+    size_t slotSize;
+} sd_context;
+
+/* All the derivatives of one output frame of one movie */
+static void sd_frame(size_t task, void *vctx)
+{
+    sd_context *ctx = (sd_context *)vctx;
+    size_t s = 0, t, torder, xorder, x, y, k, n = 0;
+    size_t Y, X, Yo, Xo, nfs = ctx->nfs, nft = ctx->nft;
+    const double *m;
+    double *tmpT, *tmpX;
+    sh_view out;
+
+    while (task >= ctx->frameStart[s + 1])
+        s++;
+    t = task - ctx->frameStart[s];
+
+    Yo = (size_t)ctx->ind[s + 1 + ctx->nIndRows];
+    Xo = (size_t)ctx->ind[s + 1 + 2 * ctx->nIndRows];
+    Y = Yo + nfs - 1;
+    X = Xo + nfs - 1;
+    m = ctx->movies[s] + t * Y * X;
+    tmpT = ctx->scratch + sh_thread_id() * ctx->slotSize;     /* Y x X  */
+    tmpX = tmpT + Y * X;                                      /* Y x Xo */
+
+    for (torder = 0; torder < ctx->nOrders; torder++) {
+        const double *ft = ctx->ftFlip + torder * nft;
+
+        /* along T */
+        for (x = 0; x < Y * X; x++)
+            tmpT[x] = 0.0;
+        for (k = 0; k < nft; k++) {
+            const double *frame = m + k * Y * X;
+            double f = ft[k];
+            for (x = 0; x < Y * X; x++)
+                tmpT[x] += frame[x] * f;
+        }
+
+        for (xorder = 0; xorder < ctx->nOrders - torder; xorder++) {
+            size_t yorder = ctx->nOrders - 1 - torder - xorder;
+            const double *fx = ctx->fs + xorder * nfs;
+            const double *fy = ctx->fsFlip + yorder * nfs;
+
+            /* ind was checked against S in mexFunction */
+            if (sh_subpop_view(&out, ctx->S, ctx->nRows, ctx->nFilters, ctx->ind, ctx->nIndRows, n, s) != 0)
+                return;
+
+            /* along X */
+            for (x = 0; x < Xo; x++) {
+                for (y = 0; y < Y; y++) {
+                    double acc = 0.0;
+                    for (k = 0; k < nfs; k++)
+                        acc += tmpT[(x + k) * Y + y] * fx[k];
+                    tmpX[x * Y + y] = acc;
+                }
+            }
+            /* along Y, into S */
+            for (x = 0; x < Xo; x++) {
+                for (y = 0; y < Yo; y++) {
+                    double acc = 0.0;
+                    for (k = 0; k < nfs; k++)
+                        acc += tmpX[x * Y + y + k] * fy[k];
+                    SH_VIEW_AT(&out, y, x, t) = acc;
+                }
+            }
+            n++;
+        }
+    }
+}
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    sd_context ctx;
+    double *fsFlip, *ftFlip;
+    size_t i, k, s, nBlocks;
+
+    /* Input validation */
+    if (nrhs != 4) {
+        mexErrMsgTxt("This function requires exactly 4 input arguments.");
+    }
+    if (!mxIsCell(prhs[0])) {
+        mexErrMsgTxt("MOVIES must be a cell array.");
+    }
+    for (i = 1; i < 4; i++) {
+        if (notDblMtx(prhs[i])) {
+            mexErrMsgTxt("IND and the filters must be real, non-sparse, double-precision matrices.");
+        }
+    }
+    if (mxGetN(prhs[1]) != 4 || mxGetM(prhs[1]) < 2) {
+        mexErrMsgTxt("IND must be an (nBlocks+1) x 4 index matrix.");
+    }
+
+    ctx.ind = mxGetPr(prhs[1]);
+    ctx.nIndRows = mxGetM(prhs[1]);
+    ctx.nRows = (size_t)ctx.ind[ctx.nIndRows - 1];
+    nBlocks = ctx.nIndRows - 1;
+    if (sh_check_ind(ctx.ind, ctx.nIndRows, ctx.nRows) != 0) {
+        mexErrMsgTxt("IND is not a valid index matrix.");
+    }
+    if (mxGetNumberOfElements(prhs[0]) != nBlocks) {
+        mexErrMsgTxt("MOVIES must hold one movie per block of IND.");
+    }
+
+    ctx.fs = mxGetPr(prhs[2]);
+    ctx.nfs = mxGetM(prhs[2]);
+    ctx.nOrders = mxGetN(prhs[2]);
+    ctx.nft = mxGetM(prhs[3]);
+    if (ctx.nfs == 0 || ctx.nft == 0 || ctx.nOrders == 0 || mxGetN(prhs[3]) != ctx.nOrders) {
+        mexErrMsgTxt("The spatial and temporal filters must have one column per derivative order.");
+    }
+    ctx.nFilters = ctx.nOrders * (ctx.nOrders + 1) / 2;
+
+    /* every movie must be the size of its block plus the filters */
+    ctx.movies = (const double **)mxMalloc(nBlocks * sizeof(double *));
+    ctx.frameStart = (size_t *)mxMalloc((nBlocks + 1) * sizeof(size_t));
+    ctx.frameStart[0] = 0;
+    ctx.slotSize = 0;
+    for (s = 0; s < nBlocks; s++) {
+        const mxArray *movie = mxGetCell(prhs[0], s);
+        const mwSize *dims;
+        size_t Y = (size_t)ctx.ind[s + 1 + ctx.nIndRows] + ctx.nfs - 1;
+        size_t X = (size_t)ctx.ind[s + 1 + 2 * ctx.nIndRows] + ctx.nfs - 1;
+        size_t T = (size_t)ctx.ind[s + 1 + 3 * ctx.nIndRows] + ctx.nft - 1;
+
+        if (movie == NULL || notDblMtx(movie) || mxGetNumberOfDimensions(movie) > 3) {
+            mexErrMsgTxt("Every movie must be a real, non-sparse, double-precision 3D matrix.");
+        }
+        dims = mxGetDimensions(movie);
+        if (dims[0] != Y || dims[1] != X ||
+            (mxGetNumberOfDimensions(movie) == 3 ? dims[2] : 1) != T) {
+            mexErrMsgTxt("A movie does not match the size of its block of IND.");
+        }
+        ctx.movies[s] = mxGetPr(movie);
+        ctx.frameStart[s + 1] = ctx.frameStart[s] + T - ctx.nft + 1;
+        if (Y * X + Y * (X - ctx.nfs + 1) > ctx.slotSize)
+            ctx.slotSize = Y * X + Y * (X - ctx.nfs + 1);
+    }
+
+    /* the temporal and Y filters are applied flipped */
+    fsFlip = (double *)mxMalloc(ctx.nfs * ctx.nOrders * sizeof(double));
+    ftFlip = (double *)mxMalloc(ctx.nft * ctx.nOrders * sizeof(double));
+    for (i = 0; i < ctx.nOrders; i++) {
+        for (k = 0; k < ctx.nfs; k++)
+            fsFlip[i * ctx.nfs + k] = ctx.fs[i * ctx.nfs + ctx.nfs - 1 - k];
+        for (k = 0; k < ctx.nft; k++)
+            ftFlip[i * ctx.nft + k] = mxGetPr(prhs[3])[i * ctx.nft + ctx.nft - 1 - k];
+    }
+    ctx.fsFlip = fsFlip;
+    ctx.ftFlip = ftFlip;
+
+    plhs[0] = mxCreateUninitNumericMatrix(ctx.nRows, ctx.nFilters, mxDOUBLE_CLASS, mxREAL);
+    ctx.S = mxGetPr(plhs[0]);
+    ctx.scratch = sh_arena_get(sh_thread_count() * ctx.slotSize);
+
+    sh_parallel_for(ctx.frameStart[nBlocks], sd_frame, &ctx);
+
+    mxFree(fsFlip);
+    mxFree(ftFlip);
+    mxFree((void *)ctx.movies);
+    mxFree(ctx.frameStart);
+    return;
+}
@@ -0,0 +1,39 @@
+% S = separableDerivatives(MOVIES, IND, SPATIALFILTERS, TEMPORALFILTERS)
+%
+% The responses of the separable directional derivative filters to each
+% movie in the cell array MOVIES (one per block of the index matrix IND),
+% stacked down the rows of S with one column per filter. Called by
+% shModelV1Separable.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function S = separableDerivatives(movies, ind, v1SpatialFilters, v1TemporalFilters)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "separableDerivatives.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+order = size(v1SpatialFilters, 2) - 1;
+fsz = size(v1SpatialFilters, 1);
+ftsz = size(v1TemporalFilters, 1);
+
+S = zeros(ind(end, 1), (order+1)*(order+2)/2);
+for block = 1:length(movies)
+    rows = ind(block, 1)+1:ind(block+1, 1);
+    n = 1;
+    for torder = 0:order
+        tfilt = reshape(flipud(v1TemporalFilters(:,torder+1)),[1 1 ftsz]);
+        tmp1 = validCorrDn3(movies{block}, tfilt);  % first conv
+        for xorder = 0:(order-torder)
+            yorder = order - torder - xorder;
+            xfilt = reshape(v1SpatialFilters(:,xorder+1),[1 fsz 1]);
+            yfilt = reshape(flipud(v1SpatialFilters(:,yorder+1)),[fsz 1 1]);
+            tmp2 = validCorrDn3(validCorrDn3(tmp1, yfilt), xfilt); % second and third convs
+
+            S(rows, n) = tmp2(:);
+            n = n + 1;
+        end
+    end
+end
@@ -0,0 +1,56 @@
+/*
+  shArena.h
+
+  Persistent scratch space for the shModel MEX kernels.
+
+  Tuning curves and fits call the model many times on stimuli of the same
+  size, and the kernels need the same scratch space every time. Instead of
+  allocating and freeing it on every call (or in every task), a kernel
+  asks the arena for it: the arena keeps one block of memory alive
+  between calls, and only reallocates it when a call needs more than any
+  call before it. In steady state the kernels allocate no scratch space.
+  The block is freed when the MEX file is cleared.
+
+  Parallel kernels ask for one slot per thread (see sh_thread_count in
+  shParallel.h) and each task uses the slot of the thread running it.
+
+  The functions (inline) and the block are static, so every MEX file that
+  includes this header has its own arena.
+*/
+
+#ifndef SHARENA_H
+#define SHARENA_H
+
+#include <stddef.h>
+#include <mex.h>
+#include "shParallel.h"
+
+static double *sh_arena_block = NULL;
+static size_t sh_arena_doubles = 0;
+
+static inline void sh_arena_free(void)
+{
+    if (sh_arena_block != NULL)
+        mxFree(sh_arena_block);
+    sh_arena_block = NULL;
+    sh_arena_doubles = 0;
+}
+
+/*
+  At least nDoubles doubles of scratch space, kept between calls. The
+  contents are not preserved when the block has to grow. Call it from the
+  main thread, before sh_parallel_for.
+*/
+static inline double *sh_arena_get(size_t nDoubles)
+{
+    if (nDoubles > sh_arena_doubles) {
+        sh_arena_free();
+        sh_arena_block = (double *)mxMalloc(nDoubles * sizeof(double));
+        mexMakeMemoryPersistent(sh_arena_block);
+        sh_arena_doubles = nDoubles;
+        sh_on_exit(sh_arena_free);
+    }
+    return sh_arena_block;
+}
+
+#endif /* SHARENA_H */
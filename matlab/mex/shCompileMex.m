@@ -15,11 +15,34 @@ mexDir = mexDir(1:pos(end));
 
 
 cd(mexDir);
-eval(['mex -outdir ', mexDir, ' ', mexDir, 'validCorrDn3.c ', mexDir, 'svalidconvolve.c']);
+
+% the kernels and the pool they share cannot be replaced while the pool's
+% threads are running
+shStopMexThreads;
+
 eval(['mex -outdir ', mexDir, ' ', mexDir, 'pointOp.c']);
 eval(['mex -outdir ', mexDir, ' ', mexDir, 'dsqr.c']);
 eval(['mex -outdir ', mexDir, ' ', mexDir, 'destructiveMatrixWriteAtIndices.c']);
 
+% kernels that split their work over the available cores (see
+% shParallel.h): on the pool of POSIX threads they all share, which lives
+% in shThreadPool, or with OpenMP on Windows. Without either they still
+% compile and run on one core.
+threadFlags = 'CFLAGS="$CFLAGS -DSH_USE_PTHREADS -pthread" LDFLAGS="$LDFLAGS -pthread" ';
+if ispc
+    threadFlags = 'COMPFLAGS="$COMPFLAGS /openmp" ';
+else
+    eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'shThreadPool.c']);
+end
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'validCorrDn3.c ', mexDir, 'svalidconvolve.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'steerSquare.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'tallSkinnyMult.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'tunedNormalization.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'stridedTrim.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'multiChannelBlur.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'pointRectify.c']);
+eval(['mex ', threadFlags, '-outdir ', mexDir, ' ', mexDir, 'separableDerivatives.c']);
+
 
 cd(startDir);
 return
\ No newline at end of file
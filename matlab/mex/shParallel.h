@@ -0,0 +1,170 @@
+/*
+  shParallel.h
+
+  A minimal parallel-for used by the shModel MEX kernels that split their
+  work over blocks of rows. Each kernel describes one block of work as a
+  task function; sh_parallel_for runs tasks 0..nTasks-1, spread over the
+  available cores, and returns when they have all finished. Tasks must
+  write disjoint parts of the output. A task that needs scratch space
+  takes the slot of its thread, sh_thread_id(), out of a block of
+  sh_thread_count() slots (see shArena.h).
+
+  How the tasks are spread depends on how the MEX file is compiled (see
+  shCompileMex.m):
+  - with SH_USE_PTHREADS, by the one pool of worker threads that all the
+    kernels share. The pool lives in its own MEX file, shThreadPool (see
+    shThreadPool.c), which starts the workers on first use and keeps
+    itself locked in memory while they run. A kernel asks shThreadPool for
+    the pool's entry points once, the first time it needs them; a call
+    then only wakes the workers, so even the millisecond-long calls made
+    on small tuning-curve stimuli gain from the extra cores. The kernels
+    themselves own no threads and can be cleared at any time. If
+    shThreadPool has not been compiled, the tasks run one after another.
+  - with OpenMP, by an OpenMP parallel loop (the OpenMP runtime already
+    keeps one pool for the whole process).
+  - otherwise one after another, on the calling thread.
+
+  sh_on_exit registers clean-up functions (freeing the arena, stopping the
+  pool) to run when the MEX file is cleared; MATLAB itself keeps only one
+  such function per MEX file.
+
+  The functions are static, so every MEX file that includes this header
+  has its own copy, and inline, so a file that uses only some of them
+  compiles without warnings about the rest.
+*/
+
+#ifndef SHPARALLEL_H
+#define SHPARALLEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mex.h>
+
+#if !defined(SH_USE_PTHREADS) && defined(_OPENMP)
+#include <omp.h>
+#endif
+
+/* A task: process block number `task` using the shared context `ctx`. */
+typedef void (*sh_task_fn)(size_t task, void *ctx);
+
+/*
+  The entry points of the shared pool, as handed out by shThreadPool. The
+  version is bumped whenever the layout changes, so a kernel compiled
+  against another layout runs serially instead of calling through it.
+*/
+#define SH_POOL_API_VERSION 1
+
+typedef struct {
+    int version;
+    size_t (*thread_count)(void);
+    size_t (*thread_id)(void);
+    void (*parallel_for)(size_t nTasks, sh_task_fn fn, void *ctx);
+} sh_pool_api;
+
+/* Clean-up functions to run when the MEX file is cleared */
+#define SH_MAX_EXIT_FNS 4
+static void (*sh_exit_fns[SH_MAX_EXIT_FNS])(void);
+static int sh_n_exit_fns = 0;
+
+static inline void sh_run_exit_fns(void)
+{
+    while (sh_n_exit_fns > 0)
+        sh_exit_fns[--sh_n_exit_fns]();
+}
+
+/* Run fn when the MEX file is cleared (once, however often it is registered) */
+static inline void sh_on_exit(void (*fn)(void))
+{
+    int i;
+
+    for (i = 0; i < sh_n_exit_fns; i++)
+        if (sh_exit_fns[i] == fn)
+            return;
+    if (sh_n_exit_fns == SH_MAX_EXIT_FNS)
+        mexErrMsgTxt("Too many clean-up functions registered.");
+    sh_exit_fns[sh_n_exit_fns++] = fn;
+    mexAtExit(sh_run_exit_fns);
+}
+
+#if defined(SH_USE_PTHREADS)
+
+static const sh_pool_api *sh_pool = NULL;
+static int sh_pool_looked_up = 0;
+
+/*
+  The shared pool, or NULL to run serially. Looked up once per load of the
+  MEX file, from the main thread, by calling shThreadPool.
+*/
+static inline const sh_pool_api *sh_pool_get(void)
+{
+    mxArray *handle = NULL;
+
+    if (sh_pool_looked_up)
+        return sh_pool;
+    sh_pool_looked_up = 1;
+    if (mexCallMATLABWithTrap(1, &handle, 0, NULL, "shThreadPool") != NULL)
+        return NULL;
+    if (mxIsUint64(handle) && mxGetNumberOfElements(handle) == 1) {
+        const sh_pool_api *api = (const sh_pool_api *)(uintptr_t)*(uint64_t *)mxGetData(handle);
+        if (api != NULL && api->version == SH_POOL_API_VERSION)
+            sh_pool = api;
+    }
+    mxDestroyArray(handle);
+    return sh_pool;
+}
+
+#endif /* SH_USE_PTHREADS */
+
+/* The most threads sh_parallel_for uses at once. Call it from the main thread. */
+static inline size_t sh_thread_count(void)
+{
+#if defined(SH_USE_PTHREADS)
+    return (sh_pool_get() != NULL) ? sh_pool->thread_count() : 1;
+#elif defined(_OPENMP)
+    return (size_t)omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/* The number, 0 .. sh_thread_count()-1, of the thread running a task. */
+static inline size_t sh_thread_id(void)
+{
+#if defined(SH_USE_PTHREADS)
+    return (sh_pool != NULL) ? sh_pool->thread_id() : 0;
+#elif defined(_OPENMP)
+    return (size_t)omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/* Run fn(0, ctx) .. fn(nTasks-1, ctx), in parallel if possible. */
+static inline void sh_parallel_for(size_t nTasks, sh_task_fn fn, void *ctx)
+{
+#if defined(SH_USE_PTHREADS)
+    size_t t;
+
+    if (nTasks > 1 && sh_pool_get() != NULL) {
+        sh_pool->parallel_for(nTasks, fn, ctx);
+        return;
+    }
+    for (t = 0; t < nTasks; t++)
+        fn(t, ctx);
+#else
+    long t;
+
+    if (nTasks < 2) {
+        if (nTasks == 1)
+            fn(0, ctx);
+        return;
+    }
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (t = 0; t < (long)nTasks; t++)
+        fn((size_t)t, ctx);
+#endif
+}
+
+#endif /* SHPARALLEL_H */
@@ -0,0 +1,19 @@
+% shStopMexThreads
+%
+% Stop the thread pool shared by the parallel shModel MEX kernels, so that
+% they and shThreadPool can be cleared or recompiled. The kernels keep the
+% entry points of the pool once they have looked them up, so they are
+% cleared first; they look the pool up again, and so start it again, the
+% next time they run. Called by shCompileMex.
+
+function shStopMexThreads()
+
+kernels = {'steerSquare', 'tallSkinnyMult', 'tunedNormalization', 'stridedTrim', ...
+    'multiChannelBlur', 'pointRectify', 'separableDerivatives', 'validCorrDn3'};
+clear(kernels{:});
+
+[mFiles, mexFiles] = inmem;
+if any(strcmp(mexFiles, 'shThreadPool'))
+    shThreadPool('stop');
+    clear shThreadPool
+end
@@ -0,0 +1,214 @@
+/*
+ * shThreadPool.c
+ *
+ * This MEX function owns the one pool of worker threads shared by all the
+ * parallel shModel MEX kernels (see shParallel.h). The kernels call it
+ * once to get the entry points of the pool and then hand their tasks to
+ * it directly; nothing else calls it during a model run.
+ *
+ * The pool is started by the first call: one worker for every core but
+ * one, the calling thread being the last. The workers wait on a condition
+ * variable between jobs, take tasks from a shared counter while a job
+ * runs, and are only stopped when asked to, or when MATLAB exits. While
+ * they exist the MEX file is locked (mexLock), so `clear mex` and
+ * `clear all` cannot unload the code the workers are running.
+ *
+ * Usage in MATLAB:
+ *   mex shThreadPool.c                       % Compile the MEX function
+ *   handle = shThreadPool()                  % Start the pool if needed
+ *   shThreadPool('stop')                     % Stop it and unlock the file
+ *
+ * Output:
+ *   - handle: A uint64 scalar holding the address of the pool's entry
+ *             points (an sh_pool_api, see shParallel.h). Only the kernels
+ *             use it.
+ *
+ * Notes:
+ *   - Use shStopMexThreads rather than shThreadPool('stop'): it first
+ *     clears the kernels, which keep the entry points, and then stops the
+ *     pool.
+ *   - Only built where POSIX threads are available; elsewhere the kernels
+ *     use OpenMP or run serially.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include <stdint.h>  /* uintptr_t */
+#include <string.h>  /* strcmp */
+#include <pthread.h>
+#include <unistd.h>  /* sysconf */
+#include "shParallel.h"
+
+#define SH_MAX_WORKERS 63
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        /* a new job was posted, or quit was set */
+    pthread_cond_t idle;        /* the last worker left the current job */
+    pthread_t threads[SH_MAX_WORKERS];
+    size_t nWorkers;
+    int started, quit;
+    unsigned long generation;   /* number of jobs posted */
+    size_t busy;                /* workers inside the current job */
+    /* the current job */
+    sh_task_fn fn;
+    void *ctx;
+    size_t nTasks;
+    size_t next;                /* next task to hand out */
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER,
+};     /* every other field starts at zero */
+
+static __thread size_t pool_tid = 0;
+
+/* Take tasks of the current job until none are left. */
+static void pool_work(sh_task_fn fn, void *ctx, size_t nTasks)
+{
+    size_t t;
+
+    while ((t = __sync_fetch_and_add(&pool.next, 1)) < nTasks)
+        fn(t, ctx);
+}
+
+static void *pool_worker(void *arg)
+{
+    unsigned long seen = 0;
+
+    pool_tid = (size_t)arg;
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        sh_task_fn fn;
+        void *ctx;
+        size_t nTasks;
+
+        while (!pool.quit && pool.generation == seen)
+            pthread_cond_wait(&pool.wake, &pool.lock);
+        if (pool.quit)
+            break;
+        seen = pool.generation;
+        fn = pool.fn;
+        ctx = pool.ctx;
+        nTasks = pool.nTasks;
+        pool.busy++;
+        pthread_mutex_unlock(&pool.lock);
+
+        pool_work(fn, ctx, nTasks);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0)
+            pthread_cond_signal(&pool.idle);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+/* Stop and join the workers, then let the MEX file be unloaded again */
+static void pool_stop(void)
+{
+    size_t i;
+
+    if (!pool.started)
+        return;
+    pthread_mutex_lock(&pool.lock);
+    pool.quit = 1;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+    for (i = 0; i < pool.nWorkers; i++)
+        pthread_join(pool.threads[i], NULL);
+    pool.nWorkers = 0;
+    pool.started = 0;
+    pool.quit = 0;
+    mexUnlock();
+}
+
+static void pool_start(void)
+{
+    long nCores = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t i, n = (nCores > 1) ? (size_t)nCores - 1 : 0;
+
+    if (n > SH_MAX_WORKERS)
+        n = SH_MAX_WORKERS;
+    pool.nWorkers = 0;
+    for (i = 0; i < n; i++) {
+        if (pthread_create(&pool.threads[i], NULL, pool_worker, (void *)(i + 1)) != 0)
+            break;
+        pool.nWorkers++;
+    }
+    pool.started = 1;
+    mexLock();
+    sh_on_exit(pool_stop);
+}
+
+static size_t pool_thread_count(void)
+{
+    return pool.nWorkers + 1;
+}
+
+static size_t pool_thread_id(void)
+{
+    return pool_tid;
+}
+
+static void pool_parallel_for(size_t nTasks, sh_task_fn fn, void *ctx)
+{
+    size_t t;
+
+    if (nTasks < 2 || pool.nWorkers == 0) {
+        for (t = 0; t < nTasks; t++)
+            fn(t, ctx);
+        return;
+    }
+
+    /* post the job, work on it alongside the workers, then wait until
+       every worker that joined it has left it. A worker that woke too
+       late for the previous job may still be leaving it; its task counter
+       must not be reset under it. */
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0)
+        pthread_cond_wait(&pool.idle, &pool.lock);
+    pool.fn = fn;
+    pool.ctx = ctx;
+    pool.nTasks = nTasks;
+    pool.next = 0;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+
+    pool_work(fn, ctx, nTasks);
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0)
+        pthread_cond_wait(&pool.idle, &pool.lock);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static const sh_pool_api pool_api = {
+    SH_POOL_API_VERSION, pool_thread_count, pool_thread_id, pool_parallel_for
+};
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    char command[8];
+
+    if (nrhs == 1) {
+        if (!mxIsChar(prhs[0]) || mxGetString(prhs[0], command, sizeof(command)) != 0 ||
+            strcmp(command, "stop") != 0) {
+            mexErrMsgTxt("The only command is 'stop'.");
+        }
+        pool_stop();
+        return;
+    }
+    if (nrhs != 0) {
+        mexErrMsgTxt("This function takes no arguments, or 'stop'.");
+    }
+
+    if (!pool.started)
+        pool_start();
+    plhs[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    *(uint64_t *)mxGetData(plhs[0]) = (uint64_t)(uintptr_t)&pool_api;
+    return;
+}
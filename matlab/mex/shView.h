@@ -0,0 +1,163 @@
+/*
+  shView.h
+
+  Strided views of the response matrices of the shModel MEX kernels.
+
+  A response matrix is positions x neurons. For every scale, the rows
+  ind(s,1)+1 .. ind(s+1,1) of a column hold one Y x X x T volume, where
+  [Y X T] = ind(s+1,2:4) (see shModel). An sh_view describes one such
+  (neuron, scale) volume in place: a pointer to its first element, its
+  size and the distance between neighbours along each dimension. Kernels
+  read and write the responses through views instead of copying each
+  volume out of the matrix and back.
+
+  sh_view_blur correlates a view with a separable 3D filter (valid
+  region, as validCorrDn3) and writes the result into another view.
+
+  The functions are static inline, so every MEX file that includes this
+  header gets its own copy of the ones it uses.
+*/
+
+#ifndef SHVIEW_H
+#define SHVIEW_H
+
+#include <stddef.h>
+
+typedef struct {
+    double *data;       /* element (0, 0, 0) */
+    size_t dims[3];     /* Y, X, T */
+    size_t stride[3];   /* in elements */
+} sh_view;
+
+/* The element (y, x, t) of view v */
+#define SH_VIEW_AT(v, y, x, t) \
+    ((v)->data[(y) * (v)->stride[0] + (x) * (v)->stride[1] + (t) * (v)->stride[2]])
+
+/*
+  Check that the nIndRows x 4 index matrix `ind` describes an nRows-row
+  response matrix: it starts at row 0, every size is a non-negative
+  integer, and every scale holds exactly Y * X * T rows. Returns 0, or -1
+  if not. Kernels that hand views to worker threads check the whole
+  matrix with this first, since a worker cannot raise an error.
+*/
+static inline int sh_check_ind(const double *ind, size_t nIndRows, size_t nRows)
+{
+    size_t s, d;
+
+    if (nIndRows < 2 || ind[0] != 0)
+        return -1;
+    for (s = 1; s < nIndRows; s++) {
+        for (d = 0; d < 4; d++) {
+            double v = ind[s + d * nIndRows];
+            if (!(v >= 0) || v != (double)(size_t)v)
+                return -1;
+        }
+        if ((size_t)ind[s - 1] + (size_t)ind[s + nIndRows] * (size_t)ind[s + 2 * nIndRows] *
+                (size_t)ind[s + 3 * nIndRows] != (size_t)ind[s])
+            return -1;
+    }
+    return ((size_t)ind[nIndRows - 1] == nRows) ? 0 : -1;
+}
+
+/*
+  Point v at the volume of (0-based) neuron `neuron` and scale `scale` of
+  the nRows-row matrix `matrix`, whose nIndRows x 4 index matrix is `ind`
+  (column-major, as passed from MATLAB). Returns 0, or -1 if the neuron
+  or scale is out of range or ind does not match the matrix.
+*/
+static inline int sh_subpop_view(sh_view *v, double *matrix, size_t nRows, size_t nCols,
+                                 const double *ind, size_t nIndRows, size_t neuron, size_t scale)
+{
+    size_t Y, X, T;
+
+    if (scale + 1 >= nIndRows || neuron >= nCols || (size_t)ind[nIndRows - 1] != nRows)
+        return -1;
+
+    Y = (size_t)ind[scale + 1 + nIndRows];
+    X = (size_t)ind[scale + 1 + 2 * nIndRows];
+    T = (size_t)ind[scale + 1 + 3 * nIndRows];
+    if ((size_t)ind[scale] + Y * X * T != (size_t)ind[scale + 1])
+        return -1;
+
+    v->data = matrix + neuron * nRows + (size_t)ind[scale];
+    v->dims[0] = Y;
+    v->dims[1] = X;
+    v->dims[2] = T;
+    v->stride[0] = 1;
+    v->stride[1] = Y;
+    v->stride[2] = Y * X;
+    return 0;
+}
+
+/*
+  The part of v that starts at (y0, x0, t0) and has size ny x nx x nt.
+  Trimming a volume is taking the middle part of its view.
+*/
+static inline sh_view sh_view_part(const sh_view *v, size_t y0, size_t x0, size_t t0,
+                                   size_t ny, size_t nx, size_t nt)
+{
+    sh_view p = *v;
+
+    p.data = &SH_VIEW_AT(v, y0, x0, t0);
+    p.dims[0] = ny;
+    p.dims[1] = nx;
+    p.dims[2] = nt;
+    return p;
+}
+
+/* The number of doubles of scratch space sh_view_blur needs */
+static inline size_t sh_view_blur_scratch(const sh_view *in, size_t nfx)
+{
+    return in->dims[0] * in->dims[1] + in->dims[0] * (in->dims[1] - nfx + 1);
+}
+
+/*
+  Correlate frames t0 .. t1-1 of out with the separable filter fy (along
+  Y) x fx (along X) x ft (along T), reading from in. out must have size
+  (Y-nfy+1) x (X-nfx+1) x (T-nft+1). Frames of out are independent, so
+  different calls may fill different frames at the same time, each with
+  its own scratch space of sh_view_blur_scratch(in, nfx) doubles.
+*/
+static inline void sh_view_blur(const sh_view *in, sh_view *out,
+                                const double *fy, size_t nfy, const double *fx, size_t nfx,
+                                const double *ft, size_t nft,
+                                size_t t0, size_t t1, double *scratch)
+{
+    size_t Y = in->dims[0], X = in->dims[1];
+    size_t Yo = out->dims[0], Xo = out->dims[1];
+    double *tmpT = scratch;             /* Y x X  */
+    double *tmpX = scratch + Y * X;     /* Y x Xo */
+    size_t t, x, y, k;
+
+    for (t = t0; t < t1; t++) {
+        /* along T */
+        for (x = 0; x < X; x++) {
+            for (y = 0; y < Y; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nft; k++)
+                    acc += SH_VIEW_AT(in, y, x, t + k) * ft[k];
+                tmpT[x * Y + y] = acc;
+            }
+        }
+        /* along X */
+        for (x = 0; x < Xo; x++) {
+            for (y = 0; y < Y; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nfx; k++)
+                    acc += tmpT[(x + k) * Y + y] * fx[k];
+                tmpX[x * Y + y] = acc;
+            }
+        }
+        /* along Y */
+        for (x = 0; x < Xo; x++) {
+            for (y = 0; y < Yo; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nfy; k++)
+                    acc += tmpX[x * Y + y + k] * fy[k];
+                SH_VIEW_AT(out, y, x, t) = acc;
+            }
+        }
+    }
+}
+
+#endif /* SHVIEW_H */
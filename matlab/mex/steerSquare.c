@@ -0,0 +1,184 @@
+/*
+ * steerSquare.c
+ *
+ * This MEX function steers the responses of the separable V1 filters to
+ * the V1 population and full-wave rectifies them in a single pass. It
+ * computes
+ *
+ *     pop = (S * W).^2 * scale
+ *
+ * and, if a steering matrix R is given, also
+ *
+ *     res = pop * R
+ *
+ * without ever forming S * W or pop.^2 as separate temporaries. The rows
+ * of S are processed in blocks; for each block the steered values are
+ * squared and scaled as they are produced, written to POP once, and kept
+ * in a small buffer from which the rows of RES are computed. The blocks
+ * are independent and are spread over the available cores (see
+ * shParallel.h).
+ *
+ * Usage in MATLAB:
+ *   mex steerSquare.c                        % Compile the MEX function
+ *   pop = steerSquare(S, W, scale)
+ *   [pop, res] = steerSquare(S, W, scale, R)
+ *
+ * Inputs:
+ *   - S:      A real, non-sparse, double-precision N x K matrix, e.g. the
+ *             responses of the separable filters from shModelV1Linear.
+ *   - W:      A real, non-sparse, double-precision K x P matrix of steering
+ *             weights, e.g. shSwts(pars.v1PopulationDirections)' times the
+ *             linear scale factor.
+ *   - scale:  A real scalar applied after squaring.
+ *   - R:      (Optional) A real, non-sparse, double-precision P x M matrix
+ *             that steers the rectified responses to M additional neurons.
+ *
+ * Notes:
+ *   - P may be at most 64 (the V1 population has 28 channels).
+ *
+ * Output:
+ *   - pop:    The N x P matrix (S * W).^2 * scale.
+ *   - res:    The N x M matrix pop * R. Only computed if R is given.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include "shParallel.h"
+
+/* Macro to check if the input is a valid double matrix */
+#define notDblMtx(matrix) (!mxIsNumeric(matrix) || !mxIsDouble(matrix) || mxIsSparse(matrix) || mxIsComplex(matrix))
+
+/* Number of rows of S handled per block. The block of steered responses
+   (BLOCK_ROWS x P doubles) stays in cache while RES is computed from it. */
+#define BLOCK_ROWS 128
+
+/* Largest number of steered channels P */
+#define MAX_CHANNELS 64
+
+typedef struct {
+    const double *S, *W, *R;
+    double *pop, *res;
+    double scale;
+    size_t N, K, P, M;
+} steer_square_context;
+
+/* Steer, square and scale the rows of block `task` of S into POP, and if
+   R is given project them onto RES. */
+static void steer_square_block(size_t task, void *vctx)
+{
+    const steer_square_context *ctx = (const steer_square_context *)vctx;
+    const double *S = ctx->S, *W = ctx->W, *R = ctx->R;
+    double *pop = ctx->pop, *res = ctx->res;
+    double scale = ctx->scale;
+    size_t N = ctx->N, K = ctx->K, P = ctx->P, M = ctx->M;
+    size_t row0 = task * BLOCK_ROWS;
+    size_t nRows = (N - row0 < BLOCK_ROWS) ? N - row0 : BLOCK_ROWS;
+    double buf[BLOCK_ROWS * MAX_CHANNELS];
+    size_t i, j, k, m;
+
+    for (j = 0; j < P; j++) {
+        double *b = buf + j * BLOCK_ROWS;
+        const double *w = W + j * K;
+
+        for (i = 0; i < nRows; i++)
+            b[i] = 0.0;
+        for (k = 0; k < K; k++) {
+            const double *s = S + k * N + row0;
+            double wk = w[k];
+            for (i = 0; i < nRows; i++)
+                b[i] += s[i] * wk;
+        }
+
+        /* the epilogue: square, scale and write the output once */
+        for (i = 0; i < nRows; i++) {
+            b[i] = b[i] * b[i] * scale;
+            pop[j * N + row0 + i] = b[i];
+        }
+    }
+
+    if (R == NULL)
+        return;
+
+    for (m = 0; m < M; m++) {
+        double *r = res + m * N + row0;
+        const double *rm = R + m * P;
+
+        for (i = 0; i < nRows; i++)
+            r[i] = 0.0;
+        for (j = 0; j < P; j++) {
+            const double *b = buf + j * BLOCK_ROWS;
+            double rjm = rm[j];
+            for (i = 0; i < nRows; i++)
+                r[i] += b[i] * rjm;
+        }
+    }
+}
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    /* Variable declarations */
+    const double *S, *W, *R = NULL;
+    double *pop, *res = NULL;
+    double scale;
+    size_t N, K, P, M = 0;
+    steer_square_context ctx;
+
+    /* Input validation */
+    if (nrhs < 3 || nrhs > 4) {
+        mexErrMsgTxt("This function requires 3 or 4 input arguments.");
+    }
+    if (notDblMtx(prhs[0])) {
+        mexErrMsgTxt("S must be a real, non-sparse, double-precision matrix.");
+    }
+    if (notDblMtx(prhs[1])) {
+        mexErrMsgTxt("W must be a real, non-sparse, double-precision matrix.");
+    }
+    if (notDblMtx(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1) {
+        mexErrMsgTxt("SCALE must be a real double-precision scalar.");
+    }
+
+    S = mxGetPr(prhs[0]);
+    N = (size_t)mxGetM(prhs[0]);
+    K = (size_t)mxGetN(prhs[0]);
+    W = mxGetPr(prhs[1]);
+    P = (size_t)mxGetN(prhs[1]);
+    if ((size_t)mxGetM(prhs[1]) != K) {
+        mexErrMsgTxt("The number of rows of W must equal the number of columns of S.");
+    }
+    if (P > MAX_CHANNELS) {
+        mexErrMsgTxt("W may have at most 64 columns.");
+    }
+    scale = mxGetScalar(prhs[2]);
+
+    if (nrhs == 4) {
+        if (notDblMtx(prhs[3])) {
+            mexErrMsgTxt("R must be a real, non-sparse, double-precision matrix.");
+        }
+        if ((size_t)mxGetM(prhs[3]) != P) {
+            mexErrMsgTxt("The number of rows of R must equal the number of columns of W.");
+        }
+        R = mxGetPr(prhs[3]);
+        M = (size_t)mxGetN(prhs[3]);
+    }
+    if (nlhs > 1 && R == NULL) {
+        mexErrMsgTxt("RES can only be returned if R is given.");
+    }
+
+    /* Allocate the outputs */
+    plhs[0] = mxCreateUninitNumericMatrix(N, P, mxDOUBLE_CLASS, mxREAL);
+    pop = mxGetPr(plhs[0]);
+    if (R != NULL) {
+        plhs[1] = mxCreateUninitNumericMatrix(N, M, mxDOUBLE_CLASS, mxREAL);
+        res = mxGetPr(plhs[1]);
+    }
+
+    ctx.S = S; ctx.W = W; ctx.R = R;
+    ctx.pop = pop; ctx.res = res;
+    ctx.scale = scale;
+    ctx.N = N; ctx.K = K; ctx.P = P; ctx.M = M;
+    sh_parallel_for((N + BLOCK_ROWS - 1) / BLOCK_ROWS, steer_square_block, &ctx);
+
+    return;
+}
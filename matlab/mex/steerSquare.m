@@ -0,0 +1,22 @@
+% [POP, RES] = steerSquare(S, W, SCALE, R)
+%
+% Steer the responses of separable filters and full-wave rectify them in
+% one pass: POP = (S * W).^2 * SCALE. If the steering matrix R is given,
+% also return RES = POP * R, the rectified responses of additional
+% neurons.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function [pop, res] = steerSquare(S, W, scale, R)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "steerSquare.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+pop = S * W;
+pop = pop.^2 * scale;
+if nargin > 3
+    res = pop * R;
+end
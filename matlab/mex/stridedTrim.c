@@ -0,0 +1,156 @@
+/*
+ * stridedTrim.c
+ *
+ * This MEX function trims the edges off every scale of a matrix of model
+ * responses with one strided copy. Each column of the input holds, for
+ * every scale, a Y x X x T volume; the output keeps the
+ * (Y-2*ty) x (X-2*tx) x (T-2*tt) block in the middle of each volume.
+ * The kept block is a part of the strided view of each volume (see
+ * shView.h), and every column of it is a contiguous run of the input, so
+ * the copy reads and writes each kept value once and needs no index
+ * vector.
+ * The (neuron, scale, frame) copies are independent and are spread over
+ * the available cores (see shParallel.h).
+ *
+ * Usage in MATLAB:
+ *   mex stridedTrim.c                        % Compile the MEX function
+ *   pop = stridedTrim(bigPop, bigInd, trimmer)
+ *
+ * Inputs:
+ *   - bigPop:  A real, non-sparse, double-precision matrix of responses,
+ *              positions x neurons, laid out as described by bigInd.
+ *   - bigInd:  The (nScales+1) x 4 index matrix of bigPop.
+ *   - trimmer: The 3-vector [ty tx tt] of values to trim off both ends of
+ *              the first, second and third dimensions.
+ *
+ * Output:
+ *   - pop:     The trimmed responses, laid out as described by the index
+ *              matrix that shTrim computes.
+ *
+ * Notes:
+ *   - shTrim is the MATLAB interface; call it rather than this function.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include <string.h>  /* memcpy */
+#include "shParallel.h"
+#include "shView.h"
+
+/* Macro to check if the input is a valid double matrix */
+#define notDblMtx(matrix) (!mxIsNumeric(matrix) || !mxIsDouble(matrix) || mxIsSparse(matrix) || mxIsComplex(matrix))
+
+typedef struct {
+    const double *in, *ind;
+    double *out, *outInd;
+    size_t nIn, nOut, nCols, nIndRows, framesPerColumn;
+    size_t *frameStart;     /* per scale */
+    size_t ty, tx, tt;
+} st_context;
+
+/* Copy one trimmed frame of one scale of one column */
+static void st_frame(size_t task, void *vctx)
+{
+    const st_context *ctx = (const st_context *)vctx;
+    size_t col = task / ctx->framesPerColumn;
+    size_t f = task % ctx->framesPerColumn;
+    size_t s = 0, t, x;
+    sh_view in, out, kept;
+
+    while (f >= ctx->frameStart[s + 1])
+        s++;
+    t = f - ctx->frameStart[s];
+
+    /* both index matrices were checked in mexFunction */
+    if (sh_subpop_view(&in, (double *)ctx->in, ctx->nIn, ctx->nCols, ctx->ind, ctx->nIndRows, col, s) != 0 ||
+        sh_subpop_view(&out, ctx->out, ctx->nOut, ctx->nCols, ctx->outInd, ctx->nIndRows, col, s) != 0)
+        return;
+    kept = sh_view_part(&in, ctx->ty, ctx->tx, ctx->tt + t, out.dims[0], out.dims[1], 1);
+
+    for (x = 0; x < out.dims[1]; x++)
+        memcpy(&SH_VIEW_AT(&out, 0, x, t), &SH_VIEW_AT(&kept, 0, x, 0),
+               out.dims[0] * sizeof(double));
+}
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    st_context ctx;
+    const double *ind, *trimmer;
+    size_t s, nRows, nCols, nScales;
+
+    /* Input validation */
+    if (nrhs != 3) {
+        mexErrMsgTxt("This function requires exactly 3 input arguments.");
+    }
+    if (notDblMtx(prhs[0]) || notDblMtx(prhs[1]) || notDblMtx(prhs[2])) {
+        mexErrMsgTxt("All inputs must be real, non-sparse, double-precision matrices.");
+    }
+    if (mxGetN(prhs[1]) != 4 || mxGetM(prhs[1]) < 2) {
+        mexErrMsgTxt("BIGIND must be an (nScales+1) x 4 index matrix.");
+    }
+    if (mxGetNumberOfElements(prhs[2]) != 3) {
+        mexErrMsgTxt("TRIMMER must be a 3-vector.");
+    }
+
+    ind = mxGetPr(prhs[1]);
+    nRows = mxGetM(prhs[1]);
+    trimmer = mxGetPr(prhs[2]);
+    for (s = 0; s < 3; s++) {
+        if (!(trimmer[s] >= 0) || trimmer[s] != (double)(size_t)trimmer[s]) {
+            mexErrMsgTxt("TRIMMER must hold non-negative integers.");
+        }
+    }
+    ctx.ty = (size_t)trimmer[0];
+    ctx.tx = (size_t)trimmer[1];
+    ctx.tt = (size_t)trimmer[2];
+    nScales = nRows - 1;
+    ctx.nIn = mxGetM(prhs[0]);
+    nCols = mxGetN(prhs[0]);
+
+    /* The workers index the matrix through views of every scale, so the
+       whole of BIGIND is checked against BIGPOP here, before they run. */
+    if (sh_check_ind(ind, nRows, ctx.nIn) != 0) {
+        mexErrMsgTxt("BIGIND does not describe the rows of BIGPOP.");
+    }
+
+    /* the index matrix of the trimmed responses, as shTrim computes it */
+    ctx.outInd = (double *)mxMalloc(4 * nRows * sizeof(double));
+    ctx.frameStart = (size_t *)mxMalloc(nRows * sizeof(size_t));
+    ctx.nIndRows = nRows;
+    ctx.nOut = 0;
+    ctx.frameStart[0] = 0;
+    for (s = 0; s < 4; s++)
+        ctx.outInd[s * nRows] = 0;
+    for (s = 0; s < nScales; s++) {
+        size_t Y = (size_t)ind[s + 1 + nRows];
+        size_t X = (size_t)ind[s + 1 + 2 * nRows];
+        size_t T = (size_t)ind[s + 1 + 3 * nRows];
+
+        if (Y < 2 * ctx.ty || X < 2 * ctx.tx || T < 2 * ctx.tt) {
+            mexErrMsgTxt("TRIMMER is larger than the response volume.");
+        }
+        ctx.nOut += (Y - 2 * ctx.ty) * (X - 2 * ctx.tx) * (T - 2 * ctx.tt);
+        ctx.outInd[s + 1] = (double)ctx.nOut;
+        ctx.outInd[s + 1 + nRows] = (double)(Y - 2 * ctx.ty);
+        ctx.outInd[s + 1 + 2 * nRows] = (double)(X - 2 * ctx.tx);
+        ctx.outInd[s + 1 + 3 * nRows] = (double)(T - 2 * ctx.tt);
+        ctx.frameStart[s + 1] = ctx.frameStart[s] + T - 2 * ctx.tt;
+    }
+    ctx.framesPerColumn = ctx.frameStart[nScales];
+
+    ctx.in = mxGetPr(prhs[0]);
+    ctx.ind = ind;
+    ctx.nCols = nCols;
+    plhs[0] = mxCreateUninitNumericMatrix(ctx.nOut, nCols, mxDOUBLE_CLASS, mxREAL);
+    ctx.out = mxGetPr(plhs[0]);
+
+    if (ctx.nOut > 0) {
+        sh_parallel_for(nCols * ctx.framesPerColumn, st_frame, &ctx);
+    }
+
+    mxFree(ctx.outInd);
+    mxFree(ctx.frameStart);
+    return;
+}
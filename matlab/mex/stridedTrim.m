@@ -0,0 +1,28 @@
+% POP = stridedTrim(BIGPOP, BIGIND, TRIMMER)
+%
+% Trim TRIMMER(d) values off both ends of dimension d of the volume of
+% every scale and neuron of BIGPOP. Called by shTrim.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function pop = stridedTrim(bigPop, bigInd, trimmer)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "stridedTrim.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+y = trimmer(1);
+x = trimmer(2);
+t = trimmer(3);
+nCols = size(bigPop, 2);
+
+pop = cell(size(bigInd, 1)-1, 1);
+for s = 1:size(bigInd, 1)-1
+    sz = bigInd(s+1, 2:4);
+    tmp = reshape(bigPop(bigInd(s, 1)+1:bigInd(s+1, 1), :), [sz, nCols]);
+    tmp = tmp(y+1:end-y, x+1:end-x, t+1:end-t, :);
+    pop{s} = reshape(tmp, [], nCols);
+end
+pop = vertcat(pop{:});
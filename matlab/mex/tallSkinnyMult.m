@@ -0,0 +1,18 @@
+% C = tallSkinnyMult(A, B)
+%
+% Multiply a tall, skinny matrix A (positions x channels) by a small
+% matrix B (channels x channels): C = A * B. The MEX version streams A
+% once in blocks of rows and spreads the blocks over the available cores;
+% when A or B has more than 64 columns it uses A * B itself.
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function C = tallSkinnyMult(A, B)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "tallSkinnyMult.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+C = A * B;
@@ -0,0 +1,293 @@
+/*
+ * tunedNormalization.c
+ *
+ * This MEX function performs the tuned divisive normalization shared by
+ * the V1 and MT stages of the model in a single pass over the population
+ * response. For every neuron it blurs the response over space and time
+ * (the normalization signal), trims the response to the blurred size (the
+ * numerator), pools the normalization signals with a weight matrix and
+ * divides:
+ *
+ *     deno = blur(pop)                      (separable, valid)
+ *     nume = trim(pop) * numeScale
+ *     out  = outScale * nume ./ (strength * deno * W + offset)
+ *
+ * The response matrix may hold several volumes, one per row of its index
+ * matrix (the scales of one stimulus, or the stimuli of a batch, see
+ * shModelBatch); each is normalized on its own. The work is split into
+ * bands of rows of one output frame of one volume. Each band is computed
+ * for all neurons at once, so the blurred and trimmed values are pooled
+ * and divided while they are still in cache, and every output is written
+ * once. The pooling reads the band of every channel straight from
+ * the deno columns just written, a run of consecutive rows at a time. The
+ * bands are spread over the available cores (see shParallel.h), with
+ * scratch space kept between calls (see shArena.h). If all the entries of
+ * W are equal, the pooling is a single sum per position.
+ *
+ * Usage in MATLAB:
+ *   mex tunedNormalization.c                 % Compile the MEX function
+ *   [out, nume, deno] = tunedNormalization(pop, popInd, spatialFilter,
+ *           temporalFilter, W, numeScale, outScale, strength, offset)
+ *
+ * Inputs:
+ *   - pop:            A real, non-sparse, double-precision response
+ *                     matrix, positions x C.
+ *   - popInd:         The index matrix of pop.
+ *   - spatialFilter:  The 1D blur filter applied along Y and along X. Its
+ *                     length must be odd.
+ *   - temporalFilter: The 1D blur filter applied along T. Its length must
+ *                     be odd.
+ *   - W:              A C x C matrix of normalization weights.
+ *   - numeScale, outScale, strength, offset:  real scalars.
+ *
+ * Output:
+ *   - out:    The normalized responses. Their index matrix is
+ *             shTrimIndices(popInd, zeros([fsz fsz ftsz])), where fsz and
+ *             ftsz are the lengths of the filters.
+ *   - nume:   The trimmed and scaled responses, with the same index matrix.
+ *   - deno:   The blurred responses, with the same index matrix, before
+ *             weighting.
+ */
+
+#include <matrix.h>  /* MATLAB matrix library */
+#include <mex.h>     /* MATLAB MEX functions */
+#include <stddef.h>  /* Standard definitions like NULL */
+#include "shParallel.h"
+#include "shView.h"
+#include "shArena.h"
+
+/* Macro to check if the input is a valid double matrix */
+#define notDblMtx(matrix) (!mxIsNumeric(matrix) || !mxIsDouble(matrix) || mxIsSparse(matrix) || mxIsComplex(matrix))
+
+/* Output rows per band */
+#define BAND_ROWS 16
+
+typedef struct {
+    const double *pop, *ind, *fs, *ft, *W;
+    double *out, *nume, *deno;
+    size_t nIn, nOut, nIndRows, C, nfs, nft;
+    size_t *taskStart, *outStart;   /* per volume */
+    double numeScale, outScale, strength, offset;
+    int uniformW;
+    double *scratch;        /* one slot of slotSize doubles per thread */
+    size_t slotSize;
+} tn_context;
+
+static void tn_band(size_t task, void *vctx)
+{
+    tn_context *ctx = (tn_context *)vctx;
+    size_t C = ctx->C, nfs = ctx->nfs, nft = ctx->nft;
+    size_t nIn = ctx->nIn, nOut = ctx->nOut, nIndRows = ctx->nIndRows;
+    size_t s = 0, Y, X, Yo, Xo, frameIn, frameOut, nBands, to, y0;
+    size_t bh, ih, ty, tt, c, j, k, x, y;
+    double *tmpT, *tmpX, *pooledAll;
+    double pooled[BAND_ROWS];
+    const double *pop;
+    double *deno, *nume, *out;
+
+    while (task >= ctx->taskStart[s + 1])
+        s++;
+    task -= ctx->taskStart[s];
+    Y = (size_t)ctx->ind[s + 1 + nIndRows];
+    X = (size_t)ctx->ind[s + 1 + 2 * nIndRows];
+    Yo = Y - nfs + 1;
+    Xo = X - nfs + 1;
+    frameIn = Y * X;
+    frameOut = Yo * Xo;
+    nBands = (Yo + BAND_ROWS - 1) / BAND_ROWS;
+    to = task / nBands;
+    y0 = (task % nBands) * BAND_ROWS;
+    bh = (Yo - y0 < BAND_ROWS) ? Yo - y0 : BAND_ROWS;
+    ih = bh + nfs - 1;                  /* input rows needed for the band */
+    ty = (nfs - 1) / 2;
+    tt = (nft - 1) / 2;
+
+    /* the volume's rows of every column start here */
+    pop = ctx->pop + (size_t)ctx->ind[s];
+    deno = ctx->deno + ctx->outStart[s];
+    nume = ctx->nume + ctx->outStart[s];
+    out = ctx->out + ctx->outStart[s];
+
+    tmpT = ctx->scratch + sh_thread_id() * ctx->slotSize;
+    tmpX = tmpT + ih * X;
+    pooledAll = tmpX + ih * Xo;
+
+    for (c = 0; c < C; c++) {
+        const double *in = pop + c * nIn;
+        double *dcol = deno + c * nOut + to * frameOut;
+        double *ncol = nume + c * nOut + to * frameOut;
+
+        /* blur along T: rows y0 .. y0+ih-1 of frame to */
+        for (x = 0; x < X; x++) {
+            for (y = 0; y < ih; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nft; k++)
+                    acc += in[(to + k) * frameIn + x * Y + y0 + y] * ctx->ft[k];
+                tmpT[x * ih + y] = acc;
+            }
+        }
+        /* blur along X */
+        for (x = 0; x < Xo; x++) {
+            for (y = 0; y < ih; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nfs; k++)
+                    acc += tmpT[(x + k) * ih + y] * ctx->fs[k];
+                tmpX[x * ih + y] = acc;
+            }
+        }
+        /* blur along Y, and trim the numerator at the same positions */
+        for (x = 0; x < Xo; x++) {
+            for (y = 0; y < bh; y++) {
+                double acc = 0.0;
+                for (k = 0; k < nfs; k++)
+                    acc += tmpX[x * ih + y + k] * ctx->fs[k];
+                dcol[x * Yo + y0 + y] = acc;
+                ncol[x * Yo + y0 + y] = ctx->numeScale *
+                    in[(to + tt) * frameIn + (x + ty) * Y + y0 + y + ty];
+            }
+        }
+    }
+
+    /* pool the normalization signals and divide, one column of the band
+       at a time. The band of each channel is bh consecutive rows of its
+       deno column, still in cache, so the pooling runs along them. */
+    for (x = 0; x < Xo; x++) {
+        size_t row0 = to * frameOut + x * Yo + y0;
+
+        if (ctx->uniformW) {
+            for (y = 0; y < bh; y++)
+                pooled[y] = 0.0;
+            for (c = 0; c < C; c++) {
+                const double *dn = deno + c * nOut + row0;
+                for (y = 0; y < bh; y++)
+                    pooled[y] += dn[y];
+            }
+            for (y = 0; y < bh; y++)
+                pooled[y] = ctx->strength * ctx->W[0] * pooled[y] + ctx->offset;
+            for (j = 0; j < C; j++) {
+                const double *nu = nume + j * nOut + row0;
+                double *o = out + j * nOut + row0;
+                for (y = 0; y < bh; y++)
+                    o[y] = ctx->outScale * nu[y] / pooled[y];
+            }
+        } else {
+            /* pooled(:, j) = deno band * W(:, j), for all j at once, so
+               each deno column is read once */
+            for (j = 0; j < C * bh; j++)
+                pooledAll[j] = 0.0;
+            for (c = 0; c < C; c++) {
+                const double *dn = deno + c * nOut + row0;
+                for (j = 0; j < C; j++) {
+                    double wc = ctx->W[j * C + c];
+                    double *p = pooledAll + j * bh;
+                    for (y = 0; y < bh; y++)
+                        p[y] += dn[y] * wc;
+                }
+            }
+            for (j = 0; j < C; j++) {
+                const double *p = pooledAll + j * bh;
+                const double *nu = nume + j * nOut + row0;
+                double *o = out + j * nOut + row0;
+                for (y = 0; y < bh; y++)
+                    o[y] = ctx->outScale * nu[y] / (ctx->strength * p[y] + ctx->offset);
+            }
+        }
+    }
+}
+
+/* Main MEX function - Entry point called from MATLAB */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    tn_context ctx;
+    size_t i, s, nScales;
+
+    /* Input validation */
+    if (nrhs != 9) {
+        mexErrMsgTxt("This function requires exactly 9 input arguments.");
+    }
+    for (i = 0; i < 9; i++) {
+        if (notDblMtx(prhs[i])) {
+            mexErrMsgTxt("All inputs must be real, non-sparse, double-precision matrices.");
+        }
+    }
+    if (mxGetN(prhs[1]) != 4 || mxGetM(prhs[1]) < 2) {
+        mexErrMsgTxt("POPIND must be an (nScales+1) x 4 index matrix.");
+    }
+
+    ctx.ind = mxGetPr(prhs[1]);
+    ctx.nIndRows = mxGetM(prhs[1]);
+    nScales = ctx.nIndRows - 1;
+    ctx.nIn = mxGetM(prhs[0]);
+    ctx.C = mxGetN(prhs[0]);
+    if (sh_check_ind(ctx.ind, ctx.nIndRows, ctx.nIn) != 0) {
+        mexErrMsgTxt("POPIND does not describe the rows of POP.");
+    }
+
+    ctx.fs = mxGetPr(prhs[2]);
+    ctx.nfs = mxGetNumberOfElements(prhs[2]);
+    ctx.ft = mxGetPr(prhs[3]);
+    ctx.nft = mxGetNumberOfElements(prhs[3]);
+    if (ctx.nfs % 2 == 0 || ctx.nft % 2 == 0) {
+        mexErrMsgTxt("The filters must have odd lengths.");
+    }
+
+    if ((size_t)mxGetM(prhs[4]) != ctx.C || (size_t)mxGetN(prhs[4]) != ctx.C) {
+        mexErrMsgTxt("W must be a C x C matrix, where C is the number of columns of POP.");
+    }
+    ctx.W = mxGetPr(prhs[4]);
+    ctx.uniformW = 1;
+    for (i = 1; i < ctx.C * ctx.C; i++) {
+        if (ctx.W[i] != ctx.W[0]) {
+            ctx.uniformW = 0;
+            break;
+        }
+    }
+
+    ctx.numeScale = mxGetScalar(prhs[5]);
+    ctx.outScale = mxGetScalar(prhs[6]);
+    ctx.strength = mxGetScalar(prhs[7]);
+    ctx.offset = mxGetScalar(prhs[8]);
+    ctx.pop = mxGetPr(prhs[0]);
+
+    /* where every volume's output starts, how many bands it has, and the
+       scratch space per thread: the band blurred along T and along X, and
+       the pooled signals of one column of the band for every channel */
+    ctx.taskStart = (size_t *)mxMalloc((nScales + 1) * sizeof(size_t));
+    ctx.outStart = (size_t *)mxMalloc((nScales + 1) * sizeof(size_t));
+    ctx.taskStart[0] = 0;
+    ctx.outStart[0] = 0;
+    ctx.slotSize = 0;
+    for (s = 0; s < nScales; s++) {
+        size_t Y = (size_t)ctx.ind[s + 1 + ctx.nIndRows];
+        size_t X = (size_t)ctx.ind[s + 1 + 2 * ctx.nIndRows];
+        size_t T = (size_t)ctx.ind[s + 1 + 3 * ctx.nIndRows];
+        size_t Yo, Xo, slot;
+
+        if (ctx.nfs > Y || ctx.nfs > X || ctx.nft > T) {
+            mexErrMsgTxt("The filters are larger than the response volume.");
+        }
+        Yo = Y - ctx.nfs + 1;
+        Xo = X - ctx.nfs + 1;
+        ctx.outStart[s + 1] = ctx.outStart[s] + Yo * Xo * (T - ctx.nft + 1);
+        ctx.taskStart[s + 1] = ctx.taskStart[s] +
+            (T - ctx.nft + 1) * ((Yo + BAND_ROWS - 1) / BAND_ROWS);
+        slot = (BAND_ROWS + ctx.nfs - 1) * (X + Xo) + BAND_ROWS * ctx.C;
+        if (slot > ctx.slotSize)
+            ctx.slotSize = slot;
+    }
+    ctx.nOut = ctx.outStart[nScales];
+
+    plhs[0] = mxCreateUninitNumericMatrix(ctx.nOut, ctx.C, mxDOUBLE_CLASS, mxREAL);
+    plhs[1] = mxCreateUninitNumericMatrix(ctx.nOut, ctx.C, mxDOUBLE_CLASS, mxREAL);
+    plhs[2] = mxCreateUninitNumericMatrix(ctx.nOut, ctx.C, mxDOUBLE_CLASS, mxREAL);
+    ctx.out = mxGetPr(plhs[0]);
+    ctx.nume = mxGetPr(plhs[1]);
+    ctx.deno = mxGetPr(plhs[2]);
+    ctx.scratch = sh_arena_get(sh_thread_count() * ctx.slotSize);
+
+    sh_parallel_for(ctx.taskStart[nScales], tn_band, &ctx);
+
+    mxFree(ctx.taskStart);
+    mxFree(ctx.outStart);
+    return;
+}
@@ -0,0 +1,22 @@
+% [OUT, NUME, DENO] = tunedNormalization(POP, POPIND, SPATIALFILTER, TEMPORALFILTER, W, NUMESCALE, OUTSCALE, STRENGTH, OFFSET)
+%
+% Tuned divisive normalization of a population response in one pass. POP
+% is a response matrix and POPIND its index matrix. DENO is POP blurred
+% (valid region) by SPATIALFILTER along Y and X and by TEMPORALFILTER
+% along T, NUME is POP trimmed to the same size and multiplied by
+% NUMESCALE, and OUT = OUTSCALE * NUME ./ (STRENGTH * DENO * W + OFFSET).
+
+%% NOTE: THIS CODE IS ONLY USED IF THE MEX FILE HAS NOT BEEN COMPILED.
+
+function [out, nume, deno] = tunedNormalization(pop, popInd, spatialFilter, temporalFilter, W, numeScale, outScale, strength, offset)
+
+persistent warned
+if isempty(warned)
+    fprintf(1,'WARNING: You should compile the MEX version of "tunedNormalization.c",\n         found in the MEX subdirectory, and put it in your matlab path.  It is faster.\n');
+    warned = 1;
+end
+
+trimmer = ([length(spatialFilter), length(spatialFilter), length(temporalFilter)] - 1)./2;
+deno = shGaussianBlur(pop, popInd, spatialFilter, temporalFilter);
+nume = shTrim(pop, popInd, trimmer) * numeScale;
+out = outScale * nume ./ (strength * deno * W + offset);
@@ -24,7 +24,8 @@
  *   - This function performs "valid" correlation, meaning only regions where the filter 
  *     fully overlaps with the image are computed, resulting in a smaller output matrix.
  *   - The function directly calls 'valid_filter' from 'svalidconvolve.c' to compute the 
- *     correlation and down-sampling.
+ *     correlation and down-sampling, one output frame per task; the frames are spread
+ *     over the available cores (see shParallel.h).
  *
  * Author: [Your Name], [Date]
  */
@@ -33,6 +34,7 @@
 #include <matrix.h>
 #include <mex.h>
 #include "convolve.h"  // Include convolve header for valid_filter function
+#include "shParallel.h"
 
 #define isValidDoubleMatrix(matrix) (mxIsNumeric(matrix) && mxIsDouble(matrix) && !mxIsSparse(matrix) && !mxIsComplex(matrix))
 
@@ -102,8 +104,36 @@ void calculateOutputDimensions(mwSize *image_dims, mwSize *filter_dims, int *ste
     result_dims[3] = image_dims[3];
 }
 
+typedef struct {
+    const double *image, *filter;
+    double *result;
+    const mwSize *image_dims, *filter_dims, *result_dims;
+    const int *step;
+} vcd_context;
+
+// Compute output frame `task`: the correlation of the filter with the
+// filter_dims[2] image frames it covers, which valid_filter sees as a
+// volume of its own.
+static void vcd_frame(size_t task, void *vctx) {
+    const vcd_context *ctx = (const vcd_context *)vctx;
+    size_t frameIn = ctx->image_dims[0] * ctx->image_dims[1];
+    size_t frameOut = ctx->result_dims[0] * ctx->result_dims[1];
+
+    valid_filter(ctx->image + task * ctx->step[2] * frameIn,
+                 ctx->image_dims[0], ctx->image_dims[1], ctx->filter_dims[2],
+                 ctx->filter, ctx->filter_dims[0], ctx->filter_dims[1], ctx->filter_dims[2],
+                 ctx->step[0], ctx->step[1], 1, ctx->result + task * frameOut);
+}
+
 void performValidCorrelation(double *image, double *filter, double *result, mwSize *image_dims, mwSize *filter_dims, int *step, mwSize *result_dims) {
-    valid_filter(image, image_dims[0], image_dims[1], image_dims[2],
-                 filter, filter_dims[0], filter_dims[1], filter_dims[2],
-                 step[0], step[1], step[2], result);
+    vcd_context ctx;
+
+    ctx.image = image;
+    ctx.filter = filter;
+    ctx.result = result;
+    ctx.image_dims = image_dims;
+    ctx.filter_dims = filter_dims;
+    ctx.result_dims = result_dims;
+    ctx.step = step;
+    sh_parallel_for(result_dims[2], vcd_frame, &ctx);
 }
@@ -0,0 +1,81 @@
+% outputs = shModelBatch(stimuli, pars, stageName, additionalNeurons, outputSpec)
+%
+% Run shModel on a batch of equal-size stimuli stored as a 4D [Y X T N]
+% matrix. Called by shModel when its stimulus has more than one entry
+% along the fourth dimension.
+%
+% The responses to the stimuli are stacked down the rows of every response
+% matrix, each stimulus with its own copy of the scales in ind (see
+% shStackIndices), and the stages run once over the whole stack. So the
+% steering and MT weighting products, the blurs and the normalization
+% each make one call for the batch, with N times the rows of a single
+% stimulus, and the MT weights are computed once. Every stage keeps the
+% volumes of ind apart, so each stimulus gets exactly the responses
+% shModel returns for it alone.
+%
+% The stimuli are run in groups, as many at a time as shModelPlan predicts
+% fit in its default memory budget of 2^28 bytes, so a large batch does
+% not need the memory of all its stimuli at once.
+%
+% outputs is a cell array holding the outputs of shModel in their usual
+% order. Each response output gains a third dimension that indexes the
+% stimuli, e.g. pop(:, :, k) is the population response to stimuli(:, :, :, k).
+% ind describes the responses to one stimulus. The reduction asked for by
+% outputSpec is applied to each stimulus after the last stage.
+
+function outputs = shModelBatch(stimuli, pars, stageName, additionalNeurons, outputSpec)
+
+nStimuli = size(stimuli, 4);
+hasRes = ~isempty(additionalNeurons);
+
+memoryBudget = 2^28;
+plan = shModelPlan([size(stimuli, 1), size(stimuli, 2), size(stimuli, 3)], pars, ...
+    stageName, size(additionalNeurons, 1));
+nAtATime = max(1, floor(memoryBudget ./ plan.peakBytes));
+
+outputs = {};
+for first = 1:nAtATime:nStimuli
+    group = first:min(first+nAtATime-1, nStimuli);
+    nGroup = length(group);
+    [pop, ind, res, aux, stage] = shModelRunStages(stimuli(:, :, :, group), pars, stageName, ...
+        additionalNeurons, 'full');
+    groupOutputs = shModelPackOutputs(stage, pop, ind, res, aux, hasRes, 'full');
+    clear pop res aux
+
+    % the stimuli hold the same number of rows each, one after another;
+    % split every response output into one slice per stimulus.
+    nScales = (size(ind, 1) - 1)./nGroup;
+    ind = ind(1:nScales+1, :);
+    groupOutputs{2} = ind;
+    isResponse = false(1, length(groupOutputs));
+    for o = [1, 3:length(groupOutputs)]
+        nCols = size(groupOutputs{o}, 2);
+        if size(groupOutputs{o}, 1) ~= nGroup*ind(end, 1)
+            continue        % not a response matrix, e.g. deno when it is 1
+        end
+        isResponse(o) = true;
+        responses = permute(reshape(groupOutputs{o}, [ind(end, 1), nGroup, nCols]), [1 3 2]);
+        if ~strcmp(outputSpec, 'full')
+            reduced = shReduceResponse(responses(:, :, 1), ind, outputSpec);
+            reduced(:, :, nGroup) = 0;
+            for k = 2:nGroup
+                reduced(:, :, k) = shReduceResponse(responses(:, :, k), ind, outputSpec);
+            end
+            responses = reduced;
+        end
+        groupOutputs{o} = responses;
+    end
+
+    % the first group sets the outputs that are not responses, and the size
+    % of the responses to the whole batch.
+    if isempty(outputs)
+        outputs = groupOutputs;
+        for o = find(isResponse)
+            outputs{o}(:, :, nStimuli) = 0;
+        end
+    else
+        for o = find(isResponse)
+            outputs{o}(:, :, group) = groupOutputs{o};
+        end
+    end
+end
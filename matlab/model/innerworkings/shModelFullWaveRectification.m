@@ -1,22 +1,11 @@
-% [pop, ind, res] = shmodv1simplerect(pop, ind, pars, resdirs)
+% [pop, ind, res] = shModelFullWaveRectification(pop, ind, pars, resdirs)
+%
+% Square and scale the V1 linear responses, in one pass by pointRectify.
 
-function varargout = shmodv1simplerect(varargin)
+function [pop, ind, res] = shModelFullWaveRectification(pop, ind, pars, resdirs)
 
-% PARSE INPUTS
-pop = varargin{1};
-ind = varargin{2};
-pars = varargin{3};
-if nargin > 3
-    resdirs = varargin{4};
-end
+pop = pointRectify(pop, pars.scaleFactors.v1FullWaveRectified);
 
-% OUTPUT
-pop = pop.^2;
-pop = pop * pars.scaleFactors.v1FullWaveRectified;
-ind = ind;
-varargout{1} = pop;
-varargout{2} = ind;
 if nargin > 3
-    res = pop * pinv(shQwts(pars.v1PopulationDirections))' * shQwts(resdirs)';
-    varargout{3} = res;
-end
\ No newline at end of file
+    res = tallSkinnyMult(pop, shV1SteeringMatrix(pars.v1PopulationDirections, resdirs));
+end
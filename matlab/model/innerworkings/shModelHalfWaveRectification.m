@@ -1,25 +1,15 @@
-% [pop, ind, res] = shmodv1simplerect(pop, ind, pars, resdirs)
+% [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res)
+%
+% Half-wave rectify the MT responses, raise them to pars.mtExponent and
+% scale them (and those of the additional neurons, res), each in one pass
+% by pointRectify.
 
-function varargout = shModelHalfWaveRectification(varargin)
+function [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res)
 
-% PARSE INPUTS
-pop = varargin{1};
-ind = varargin{2};
-pars = varargin{3};
+scale = pars.scaleFactors.mtHalfWaveRectification;
 
 if nargin > 3
-    res = varargin{4};
-    res = res + pars.mtAlpha;
-    res = (res>0).*res.^pars.mtExponent;
+    res = pointRectify(res, scale, pars.mtAlpha, pars.mtExponent);
 end
 
-pop = pop + pars.mtAlpha;
-pop = (pop>0).*pop.^pars.mtExponent;
-
-ind = ind;
-
-varargout{1} = pop.*pars.scaleFactors.mtHalfWaveRectification;
-varargout{2} = ind;
-if nargin > 3
-    varargout{3} = res.*pars.scaleFactors.mtHalfWaveRectification;
-end
+pop = pointRectify(pop, scale, pars.mtAlpha, pars.mtExponent);
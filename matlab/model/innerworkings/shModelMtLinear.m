@@ -10,8 +10,18 @@ if nargin > 3
 end
 
 
-varargout{1} = pop*shMtWts(popvels, pars)'.*pars.scaleFactors.mtLinear;
+% the weights for the MT population only change with the population
+% itself, so keep them between calls.
+persistent cachedPopvels cachedV1dirs cachedPopWts
+if isempty(cachedPopWts) || ~isequal(popvels, cachedPopvels) ...
+        || ~isequal(pars.v1PopulationDirections, cachedV1dirs)
+    cachedPopWts = shMtWts(popvels, pars);
+    cachedPopvels = popvels;
+    cachedV1dirs = pars.v1PopulationDirections;
+end
+
+varargout{1} = tallSkinnyMult(pop, cachedPopWts').*pars.scaleFactors.mtLinear;
 varargout{2} = ind;
 if nargin > 3
-    varargout{3} = pop*shMtWts(resvels, pars)'.*pars.scaleFactors.mtLinear;
+    varargout{3} = tallSkinnyMult(pop, shMtWts(resvels, pars)').*pars.scaleFactors.mtLinear;
 end
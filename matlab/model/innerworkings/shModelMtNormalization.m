@@ -4,6 +4,10 @@
 % responses; nrm contains the normalization signal.
 % Extraneurons is a four-dimensional matrix containing the responses of
 % neurons not in the the population
+% For 'tuned' normalization, a normalization signal returned as deno by an
+% earlier call on the same pop can be passed as a 7th argument so it is
+% not computed again; pop may then be empty, in which case only the
+% additional neurons are normalized.
 
 function varargout = shModelMtNormalization(varargin)
 
@@ -15,6 +19,14 @@ if nargin > 3
     res = varargin{4};
     resvels = varargin{5};
 end
+outputSpec = 'full';
+if nargin > 5
+    outputSpec = varargin{6};
+end
+deno = [];
+if nargin > 6
+    deno = varargin{7};
+end
 
 if strcmp(pars.mtNormalizationType, 'global')
     if nargin < 4
@@ -27,7 +39,7 @@ elseif strcmp(pars.mtNormalizationType, 'tuned')
     if nargin < 4
         [pop, ind, nume, deno] = shModelMtNormalization_Tuned(pop, ind, pars);
     else
-        [pop, ind, nume, deno, res, resnume, resdeno] = shModelMtNormalization_Tuned(pop, ind, pars, res, resvels);
+        [pop, ind, nume, deno, res, resnume, resdeno] = shModelMtNormalization_Tuned(pop, ind, pars, res, resvels, outputSpec, deno);
     end
 
 elseif strcmp(pars.mtNormalizationType, 'self')
@@ -14,6 +14,14 @@ if nargin > 3
     res = varargin{4};
     resvels = varargin{5};
 end
+outputSpec = 'full';
+if nargin > 5
+    outputSpec = varargin{6};
+end
+deno = [];
+if nargin > 6
+    deno = varargin{7};
+end
  
 % get the filters ready. We have to reshape them into 3D filters.
 xfilt = pars.mtNormalizationSpatialFilter;
@@ -21,27 +29,66 @@ tfilt = pars.mtNormalizationSpatialFilter;
 trimmer = [length(xfilt), length(xfilt), length(tfilt)];
 trimmer = trimmer - 1;
 trimmer = trimmer./2;
-deno = shGaussianBlur(pop, ind, xfilt, tfilt);
+% without a precomputed normalization signal, the blur, trim, pooling and
+% division for the population are done in one pass by the
+% tunedNormalization kernel, which also returns the blurred signal for the
+% additional neurons below.
+fused = isempty(deno);
+if fused
+    [popOut, popNume, deno] = tunedNormalization(pop, ind, xfilt, tfilt, ...
+        ones(size(pop, 2)), 1, pars.scaleFactors.mtPattern, normstrength, mtsigma.^2);
+end
 
 
 % now get normalizing
 if nargin > 3
-    resnume = shTrim(res, ind, trimmer);
-    normwts = ones(size(res, 2), size(deno, 2))';
-    resdeno = deno*normwts;
-    
-    res = pars.scaleFactors.mtPattern.*resnume./(normstrength.*resdeno + mtsigma.^2);
-    
+    % if only a summary of the responses was asked for, compute the
+    % additional neurons a block at a time and reduce each block before
+    % moving on to the next, so their full responses are never stored.
+    nRes = size(res, 2);
+    blockSize = nRes;
+    if ~strcmp(outputSpec, 'full')
+        blockSize = 64;
+    end
+    linres = res;
+    res = [];
+    resnume = [];
+    resdeno = [];
+    for b = 1:blockSize:nRes
+        cols = b:min(b+blockSize-1, nRes);
+        [blockNume, resind] = shTrim(linres(:, cols), ind, trimmer);
+        normwts = ones(length(cols), size(deno, 2))';
+        [pooled, colScale] = shNormalizationPool(deno, normwts);
+        blockRes = shNormalizationDivide(pars.scaleFactors.mtPattern.*blockNume, pooled, colScale, ...
+            normstrength, mtsigma.^2);
+        blockDeno = shNormalizationExpand(pooled, colScale);
+
+        res(:, cols) = shReduceResponse(blockRes, resind, outputSpec);
+        resnume(:, cols) = shReduceResponse(blockNume, resind, outputSpec);
+        resdeno(:, cols) = shReduceResponse(blockDeno, resind, outputSpec);
+    end
+    clear linres
     
     varargout{5} = res;
     varargout{6} = resnume;
     varargout{7} = resdeno;
 end
 
-[pop, ind] = shTrim(pop, ind, trimmer);
-nume = pop;
-normwts = ones(size(pop, 2), size(deno, 2))';
-pop = pars.scaleFactors.mtPattern.*pop./(normstrength.*deno*normwts' + mtsigma.^2);
+if fused
+    pop = popOut;
+    nume = popNume;
+    ind = shTrimIndices(ind, zeros(2*trimmer + 1));
+elseif isempty(pop)
+    % only the additional neurons were asked for (see shMtVelocityField)
+    nume = [];
+    ind = shTrimIndices(ind, zeros(2*trimmer + 1));
+else
+    [pop, ind] = shTrim(pop, ind, trimmer);
+    nume = pop;
+    normwts = ones(size(pop, 2), size(deno, 2))';
+    [pooled, colScale] = shNormalizationPool(deno, normwts');
+    pop = shNormalizationDivide(pars.scaleFactors.mtPattern.*pop, pooled, colScale, normstrength, mtsigma.^2);
+end
 
 varargout{1} = pop;
 varargout{2} = ind;
@@ -0,0 +1,33 @@
+% outputs = shModelPackOutputs(stage, pop, ind, res, aux, hasRes, outputSpec)
+%
+% Arrange the results of the last stage run by shModel into the cell array
+% of outputs shModel returns, reducing every response output according to
+% outputSpec (see shReduceResponse). stage, pop, ind, res and aux are as
+% returned by shModelRunStage.
+
+function outputs = shModelPackOutputs(stage, pop, ind, res, aux, hasRes, outputSpec)
+
+switch stage
+    case 'v1Linear'
+        if hasRes
+            outputs = {pop, ind, res, aux.S};
+        else
+            outputs = {pop, ind, aux.S};
+        end
+    case {'v1Normalization', 'mtNormalization'}
+        if hasRes
+            outputs = {pop, ind, res, aux.nume, aux.deno, aux.resnume, aux.resdeno};
+        else
+            outputs = {pop, ind, aux.nume, aux.deno};
+        end
+    otherwise
+        if hasRes
+            outputs = {pop, ind, res};
+        else
+            outputs = {pop, ind};
+        end
+end
+
+for k = [1, 3:length(outputs)]
+    outputs{k} = shReduceResponse(outputs{k}, ind, outputSpec);
+end
@@ -0,0 +1,102 @@
+% [pop, ind, res, aux] = shModelRunStage(stage, pop, ind, pars, res, resNeurons, computeRes, outputSpec)
+%
+% Run one stage of the model, as listed by shModelStageList.
+%
+% pop and ind are the output of the previous stage (for 'v1Linear' and
+% 'v1LinearRectified', pop is the stimulus). If computeRes is true the
+% stage also returns the responses of the additional neurons resNeurons:
+% stages that steer their responses from the population ('v1Linear'
+% through 'v1Normalization', including 'v1LinearRectified', and
+% 'mtLinear') compute res from pop, all other stages transform the res
+% passed in. outputSpec is passed on to the normalization stages so they
+% can reduce the responses of additional neurons as they compute them (see
+% shReduceResponse). aux holds the extra outputs of some stages: S for
+% 'v1Linear'; nume, deno, resnume and resdeno for the normalization stages.
+%
+% pop and res are passed in and returned under the same names, here and by
+% the callers, so the input of a stage is released as soon as its output
+% is assigned and no more than the two of them are held at once.
+
+function [pop, ind, res, aux] = shModelRunStage(stage, pop, ind, pars, res, resNeurons, computeRes, outputSpec)
+
+if nargin < 8
+    outputSpec = 'full';
+end
+aux = struct('S', [], 'nume', [], 'deno', [], 'resnume', [], 'resdeno', []);
+
+switch stage
+    case 'v1Linear'
+        if computeRes
+            [pop, ind, aux.S, res] = shModelV1Linear(pop, pars, resNeurons);
+        else
+            [pop, ind, aux.S] = shModelV1Linear(pop, pars);
+        end
+
+    case 'v1LinearRectified'
+        if computeRes
+            [pop, ind, res] = shModelV1LinearRectified(pop, pars, resNeurons);
+        else
+            [pop, ind] = shModelV1LinearRectified(pop, pars);
+        end
+
+    case 'v1FullWaveRectification'
+        if computeRes
+            [pop, ind, res] = shModelFullWaveRectification(pop, ind, pars, resNeurons);
+        else
+            [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
+        end
+
+    case 'v1Blur'
+        if computeRes
+            [pop, ind, res] = shModelV1Blur(pop, ind, pars, resNeurons);
+        else
+            [pop, ind] = shModelV1Blur(pop, ind, pars);
+        end
+
+    case 'v1Normalization'
+        if computeRes
+            [pop, ind, aux.nume, aux.deno, res, aux.resnume, aux.resdeno] = ...
+                shModelV1Normalization(pop, ind, pars, resNeurons, outputSpec);
+        else
+            [pop, ind, aux.nume, aux.deno] = shModelV1Normalization(pop, ind, pars);
+        end
+
+    case 'mtLinear'
+        if computeRes
+            [pop, ind, res] = shModelMtLinear(pop, ind, pars, resNeurons);
+        else
+            [pop, ind] = shModelMtLinear(pop, ind, pars);
+        end
+
+    case 'mtPreThresholdBlur'
+        if computeRes
+            [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
+        else
+            [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
+        end
+
+    case 'halfWaveRectification'
+        if computeRes
+            [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res);
+        else
+            [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
+        end
+
+    case 'mtPostThresholdBlur'
+        if computeRes
+            [pop, ind, res] = shModelMtPostThresholdBlur(pop, ind, pars, res);
+        else
+            [pop, ind] = shModelMtPostThresholdBlur(pop, ind, pars);
+        end
+
+    case 'mtNormalization'
+        if computeRes
+            [pop, ind, aux.nume, aux.deno, res, aux.resnume, aux.resdeno] = ...
+                shModelMtNormalization(pop, ind, pars, res, resNeurons, outputSpec);
+        else
+            [pop, ind, aux.nume, aux.deno] = shModelMtNormalization(pop, ind, pars);
+        end
+
+    otherwise
+        error([stage, ' is not a recognized model stage.']);
+end
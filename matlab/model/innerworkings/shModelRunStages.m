@@ -0,0 +1,36 @@
+% [pop, ind, res, aux, stage] = shModelRunStages(stimulus, pars, stageName, additionalNeurons, outputSpec)
+%
+% Run the stimulus through every stage of the model up to stageName (see
+% shModelStageList), one stage after another. Used by shModel and
+% shModelBatch.
+%
+% stimulus is [Y X T], or a batch of stimuli stacked along a fourth
+% dimension; the responses to a batch follow one another down the rows of
+% every response matrix and ind describes them all (see shStackIndices).
+% The responses of the additionalNeurons are steered from the population
+% at the last stage that can do so, and carried through the stages after
+% it. outputSpec is passed on to the last stage (see shModelRunStage). pop,
+% ind, res and aux are as returned by the last stage, and stage is its
+% name.
+
+function [pop, ind, res, aux, stage] = shModelRunStages(stimulus, pars, stageName, additionalNeurons, outputSpec)
+
+hasRes = ~isempty(additionalNeurons);
+stages = shModelStageList(stageName);
+steeringStages = {'v1Linear', 'v1LinearRectified', 'v1FullWaveRectification', 'v1Blur', ...
+    'v1Normalization', 'mtLinear'};
+firstResStage = find(ismember(stages, steeringStages), 1, 'last');
+
+pop = stimulus;
+ind = [];
+res = [];
+for i = 1:length(stages)
+    computeRes = hasRes && i >= firstResStage;
+    stageSpec = 'full';
+    if i == length(stages)
+        stageSpec = outputSpec;
+    end
+    [pop, ind, res, aux] = shModelRunStage(stages{i}, pop, ind, pars, res, ...
+        additionalNeurons, computeRes, stageSpec);
+end
+stage = stages{end};
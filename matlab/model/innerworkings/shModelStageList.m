@@ -0,0 +1,39 @@
+% stages = shModelStageList(stageName)
+%
+% The stages, in order, that shModel runs through to compute the output of
+% stageName. Each entry is a name understood by shModelRunStage.
+
+function stages = shModelStageList(stageName)
+
+% the linear stage and the full-wave rectification that follows it are
+% run as one fused stage unless the linear responses themselves are wanted.
+v1Stages = {'v1LinearRectified', 'v1Blur', 'v1Normalization'};
+
+switch lower(stageName)
+    case 'v1lin'
+        stages = {'v1Linear'};
+    case 'v1halfrect'
+        stages = {'v1Linear', 'halfWaveRectification'};
+    case 'v1simple'
+        stages = {'v1Linear', 'halfWaveRectification', 'v1Normalization'};
+    case 'v1fullrect'
+        stages = v1Stages(1);
+    case 'v1blur'
+        stages = v1Stages(1:2);
+    case 'v1complex'
+        stages = v1Stages;
+    case 'mtlin'
+        stages = [v1Stages, {'mtLinear'}];
+    case 'mtprepool'
+        stages = [v1Stages, {'mtLinear', 'mtPreThresholdBlur'}];
+    case 'mthalfrect'
+        stages = [v1Stages, {'mtLinear', 'mtPreThresholdBlur', 'halfWaveRectification'}];
+    case 'mtpostpool'
+        stages = [v1Stages, {'mtLinear', 'mtPreThresholdBlur', 'halfWaveRectification', ...
+            'mtPostThresholdBlur'}];
+    case 'mtpattern'
+        stages = [v1Stages, {'mtLinear', 'mtPreThresholdBlur', 'halfWaveRectification', ...
+            'mtPostThresholdBlur', 'mtNormalization'}];
+    otherwise
+        error([stageName, ' is not a recognized stage name.']);
+end
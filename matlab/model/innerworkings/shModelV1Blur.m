@@ -25,6 +25,6 @@ pop = pop*pars.scaleFactors.v1Blur;
 varargout{1} = pop;
 varargout{2} = ind;
 if nargin > 3
-    res = pop * pinv(shQwts(popdirs))' * shQwts(resdirs)';
+    res = tallSkinnyMult(pop, shV1SteeringMatrix(popdirs, resdirs));
     varargout{3} = res;
 end
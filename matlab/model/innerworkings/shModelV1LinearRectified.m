@@ -0,0 +1,35 @@
+% [pop, ind, res] = shModelV1LinearRectified(M, pars, resdirs)   linear V1 responses, steered and full-wave rectified in one pass
+%
+% Equivalent to running shModelV1Linear followed by
+% shModelFullWaveRectification, but the steering of the separable filter
+% responses to the V1 population, the squaring and both scale factors are
+% done by one call to steerSquare, so the unrectified population response
+% is never stored. M is a 3D movie whose dimensions are [y, x, t]; pars is
+% an SH model parameters structure. If resdirs is supplied, res contains
+% the rectified responses of the V1 neurons it specifies, steered from
+% the rectified population in the same pass.
+
+function varargout = shModelV1LinearRectified(varargin)
+
+M = varargin{1};
+pars = varargin{2};
+if nargin > 2
+    resdirs = varargin{3};
+end
+
+mSz = [size(M, 1), size(M, 2), size(M, 3)];
+if any(mSz < shGetDims(pars, 'v1lin'))
+    error('Stimulus is too small for computation of V1lin stage.');
+end
+
+[S, ind] = shModelV1Separable(M, pars);
+W = shSwts(pars.v1PopulationDirections)' * pars.scaleFactors.v1Linear;
+scale = pars.scaleFactors.v1FullWaveRectified;
+
+varargout{2} = ind;
+if nargin > 2
+    steer = shV1SteeringMatrix(pars.v1PopulationDirections, resdirs);
+    [varargout{1}, varargout{3}] = steerSquare(S, W, scale, steer);
+else
+    varargout{1} = steerSquare(S, W, scale);
+end
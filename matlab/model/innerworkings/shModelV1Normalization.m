@@ -10,6 +10,10 @@ pars = varargin{3};
 if nargin > 3
     resdirs = varargin{4};
 end
+outputSpec = 'full';
+if nargin > 4
+    outputSpec = varargin{5};
+end
 
 % call a the normalization routine specified by pars.v1normtype.
 if strcmp(v1normtype, 'off')
@@ -25,8 +29,10 @@ if strcmp(v1normtype, 'off')
     varargout{4} = deno;
     
     if nargin > 3
-        res = pop * pinv(shQwts(popdirs))' * shQwts(resdirs)';     
+        res = tallSkinnyMult(pop, shV1SteeringMatrix(popdirs, resdirs));     
         varargout{5} = res;
+        varargout{6} = res;
+        varargout{7} = deno;
     end
 
 elseif strcmp(v1normtype, 'global')        % OLD, UNIFORM NORMALIZATION
@@ -56,7 +62,7 @@ elseif strcmp(v1normtype, 'tuned')                       % NEW, TUNED NORMALIZAT
         varargout{3} = nume;
         varargout{4} = deno;
     else
-        [pop, ind, nume, deno, res, resnume, resdeno] = shModelV1Normalization_Tuned(pop, ind, pars, resdirs);
+        [pop, ind, nume, deno, res, resnume, resdeno] = shModelV1Normalization_Tuned(pop, ind, pars, resdirs, outputSpec);
         varargout{1} = pop;
         varargout{2} = ind;
         varargout{3} = nume;
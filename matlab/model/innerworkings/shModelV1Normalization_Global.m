@@ -47,6 +47,6 @@ varargout{3} = nume;
 varargout{4} = deno;
 
 if nargin > 3
-    res = pop * pinv(shQwts(popdirs))' * shQwts(resdirs)';
+    res = tallSkinnyMult(pop, shV1SteeringMatrix(popdirs, resdirs));
     varargout{5} = res;
 end
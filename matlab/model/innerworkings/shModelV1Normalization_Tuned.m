@@ -13,6 +13,10 @@ pars = varargin{3};
 if nargin > 3
     resdirs = varargin{4};
 end
+outputSpec = 'full';
+if nargin > 4
+    outputSpec = varargin{5};
+end
 
 % get the filters ready. We have to reshape them into 3D filters.
 xfilt = pars.v1NormalizationSpatialFilter;
@@ -20,14 +24,15 @@ tfilt = pars.v1NormalizationTemporalFilter;
 trimmer = [length(xfilt), length(xfilt), length(tfilt)];
 trimmer = trimmer - 1;
 trimmer = trimmer./2;
-deno = shGaussianBlur(pop, ind, xfilt, tfilt);
-
-% now get normalizing
-[pop, ind] = shTrim(pop, ind, trimmer);
-nume = pop * pars.scaleFactors.v1Complex;
 normwts = shModelV1Normalization_TunedWts(popdirs, popdirs)';
 normwts = normwts*pars.scaleFactors.v1NormalizationPopulationK;
-pop = nume./(normstrength.*deno*normwts + v1sigma.^2);
+
+% now get normalizing. The blur, trim, pooling and division are done in
+% one pass, for every scale (and every stimulus of a batch), by the
+% tunedNormalization kernel.
+[pop, nume, deno] = tunedNormalization(pop, ind, xfilt, tfilt, normwts, ...
+    pars.scaleFactors.v1Complex, 1, normstrength, v1sigma.^2);
+ind = shTrimIndices(ind, zeros(2*trimmer + 1));
 
 varargout{1} = pop;
 varargout{2} = ind;
@@ -37,11 +42,30 @@ varargout{4} = deno;
 if nargin > 3
     normwts = shModelV1Normalization_TunedWts(resdirs, popdirs)';
     normwts = normwts*pars.scaleFactors.v1NormalizationPopulationK;
-    
-    resnume = nume * pinv(shQwts(popdirs))' * shQwts(resdirs)';
-    resdeno = deno*normwts;
+    steer = shV1SteeringMatrix(popdirs, resdirs);
+
+    % if only a summary of the responses was asked for, compute the
+    % additional neurons a block at a time and reduce each block before
+    % moving on to the next, so their full responses are never stored.
+    nRes = size(resdirs, 1);
+    blockSize = nRes;
+    if ~strcmp(outputSpec, 'full')
+        blockSize = 64;
+    end
+    res = [];
+    resnume = [];
+    resdeno = [];
+    for b = 1:blockSize:nRes
+        cols = b:min(b+blockSize-1, nRes);
+        blockNume = tallSkinnyMult(nume, steer(:, cols));
+        [pooled, colScale] = shNormalizationPool(deno, normwts(:, cols));
+        blockRes = shNormalizationDivide(blockNume, pooled, colScale, normstrength, v1sigma.^2);
+        blockDeno = shNormalizationExpand(pooled, colScale);
 
-    res = resnume./(normstrength.*resdeno + v1sigma.^2);
+        res(:, cols) = shReduceResponse(blockRes, ind, outputSpec);
+        resnume(:, cols) = shReduceResponse(blockNume, ind, outputSpec);
+        resdeno(:, cols) = shReduceResponse(blockDeno, ind, outputSpec);
+    end
     
     varargout{5} = res;
     varargout{6} = resnume;
@@ -0,0 +1,28 @@
+% [S, ind] = shModelV1Separable(M, pars)
+%
+% The responses of the separable directional derivative filters that are
+% the front end of the V1 stage, at every scale. M is a 3D movie whose
+% dimensions are [y, x, t], or a batch of such movies stacked along a
+% fourth dimension; S has one column per separable filter (10 for the
+% third-order filters in pars.v1SpatialFilters and pars.v1TemporalFilters)
+% and ind is its index matrix. For a batch, the responses to the movies
+% follow one another down the rows of S (see shStackIndices). The
+% responses of any V1 neuron are a weighting of the columns of S, see
+% shSwts.
+
+function [S, ind] = shModelV1Separable(M, pars)
+
+nScales = pars.nScales;
+
+% the sizes of all the scales are known from the size of the stimulus, so
+% S is allocated once at its final size, and separableDerivatives writes
+% every filter output straight into its rows of S.
+nStimuli = size(M, 4);
+ind = shModelV1SeparablePlan([size(M, 1), size(M, 2), size(M, 3)], pars);
+ind = shStackIndices(ind, nStimuli);
+movies = cell(nStimuli*nScales, 1);
+for block = 1:nStimuli*nScales
+    scale = mod(block-1, nScales) + 1;
+    movies{block} = blurDn3(M(:, :, :, ceil(block./nScales)), scale);
+end
+S = separableDerivatives(movies, ind, pars.v1SpatialFilters, pars.v1TemporalFilters);
@@ -0,0 +1,31 @@
+% ind = shModelV1SeparablePlan(stimulusSize, pars)
+%
+% The index matrix of the separable V1 filter responses (S in
+% shModelV1Separable) to a stimulus of size stimulusSize = [Y X T], worked
+% out from the sizes alone, the way shGetDims does, without filtering
+% anything. shModelV1Separable uses it to allocate S once, at its final
+% size, for all the scales.
+%
+% Scale s filters the stimulus blurred and downsampled s-1 times by
+% blurDn3, each time with its default 5-tap filter (a valid correlation,
+% then every other sample), and the filters then trim their length minus
+% one off each dimension.
+
+function ind = shModelV1SeparablePlan(stimulusSize, pars)
+
+fsz = size(pars.v1SpatialFilters, 1);
+tsz = size(pars.v1TemporalFilters, 1);
+blurSz = 5;
+
+ind = zeros(pars.nScales+1, 4);
+sz = stimulusSize(1:3);
+for scale = 1:pars.nScales
+    if scale > 1
+        sz = ceil((sz - blurSz + 1)./2);
+    end
+    ind(scale+1, 2:4) = sz - [fsz-1, fsz-1, tsz-1];
+    if any(ind(scale+1, 2:4) < 1)
+        error('Stimulus is too small for the separable V1 filters at scale %d.', scale);
+    end
+    ind(scale+1, 1) = ind(scale, 1) + prod(ind(scale+1, 2:4));
+end
@@ -5,12 +5,14 @@
 % Required argument:
 % mtNeuron          The parameters of an MT neuron. The first element is
 %                   the preferred direction with 0 = right. The second is
-%                   the preferred speed in pixels/frame.
+%                   the preferred speed in pixels/frame. mtNeuron can also
+%                   be an Nx2 matrix with one MT neuron per row.
 %
 % Output:
-% v1Components      a 4x2 matrix. Each row contains the parameters of one
+% v1Components      a 4Nx2 matrix. Each row contains the parameters of one
 %                   of the V1 neurons that feeds forward to the MT neuron
-%                   specified by mtNeuron. The first column gives the
+%                   specified by mtNeuron; rows 4n-3 to 4n belong to the
+%                   n-th MT neuron. The first column gives the
 %                   neuron's preferred direction in radians with 0 = right.
 %                   The second column is the ratio of the neuron's
 %                   preferred temporal frequency to spatial frequency in
@@ -18,21 +20,22 @@
 
 function v1Components = shMtV1Components(mtNeuron)
 
-oldVel = mtNeuron;
-mtNeuron(:, 1) = oldVel(:,2).*sin(oldVel(:,1));
-mtNeuron(:, 2) = oldVel(:,2).*cos(oldVel(:,1));
+nNeurons = size(mtNeuron, 1);
+vel = [mtNeuron(:,2).*sin(mtNeuron(:,1)), mtNeuron(:,2).*cos(mtNeuron(:,1))];
+speed2 = sum(vel.^2, 2);
+
+% two unit vectors spanning the plane of the MT neuron's velocity in 3D
+% Fourier space. A neuron that prefers no motion gets the XY plane.
+d1 = [-vel(:,1), -vel(:,2), speed2];
+d1 = d1 ./ repmat(sqrt(sum(d1.^2, 2)), 1, 3);
+d2 = [-vel(:,2), vel(:,1), zeros(nNeurons, 1)];
+d2 = d2 ./ repmat(sqrt(sum(d2.^2, 2)), 1, 3);
+still = speed2 <= 10*eps;
+d1(still, :) = repmat([1 0 0], sum(still), 1);
+d2(still, :) = repmat([0 1 0], sum(still), 1);
 
-if (sum(mtNeuron.^2) > 10*eps)
-    d1 = [ -mtNeuron(1), -mtNeuron(2), sum(mtNeuron.^2)];
-    d1 = d1/norm(d1);
-    d2 = [ -mtNeuron(2), mtNeuron(1),  0          ];
-    d2 = d2/norm(d2);
-else
-    d1 = [1 0 0];
-    d2 = [0 1 0];
-end
 angles = pi*[0:3]'/(3+1);
-v1Components = cos(angles)*d1 + sin(angles)*d2;
+v1Components = kron(d1, cos(angles)) + kron(d2, sin(angles));
 
 v1Components = rec2sphere(v1Components);
 v1Components(:,3) = [];
@@ -12,10 +12,18 @@
 
 function wts = shMtWts(mtNeurons, pars)
 
-wts = [];
-for i = 1:size(mtNeurons, 1)
-    dirs = shMtV1Components(mtNeurons(i,:));
-    tmp = sum(shQwts(dirs) * pinv(shQwts(pars.v1PopulationDirections)));
-    tmp = tmp-mean(tmp);
-    wts = [wts; tmp];
+% the weights of each MT neuron are the sum of the interpolation weights of
+% its four V1 components. They are built for a block of neurons at a time
+% to bound the size of the intermediate 4N x 28 matrix.
+qInv = shQwtsInverse(pars.v1PopulationDirections);
+nNeurons = size(mtNeurons, 1);
+nV1 = size(qInv, 2);
+blockSize = 4096;
+wts = zeros(nNeurons, nV1);
+for b = 1:blockSize:nNeurons
+    rows = b:min(b+blockSize-1, nNeurons);
+    dirs = shMtV1Components(mtNeurons(rows, :));
+    tmp = shQwts(dirs) * qInv;
+    tmp = reshape(sum(reshape(tmp, [4, length(rows), nV1]), 1), [length(rows), nV1]);
+    wts(rows, :) = tmp - repmat(mean(tmp, 2), 1, nV1);
 end
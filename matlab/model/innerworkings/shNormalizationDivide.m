@@ -0,0 +1,20 @@
+% res = shNormalizationDivide(nume, pooled, colScale, strength, offset)
+%
+% Divisive normalization by a pooled signal from shNormalizationPool:
+%   res = nume ./ (strength .* pooled*colScale + offset)
+% (with pooled*colScale read as pooled if colScale is empty). When the
+% pooled signal is a single vector it is broadcast over the columns of
+% nume, so no positions x neurons denominator is stored.
+
+function res = shNormalizationDivide(nume, pooled, colScale, strength, offset)
+
+if isempty(colScale)
+    res = nume ./ (strength .* pooled + offset);
+elseif all(colScale == colScale(1))
+    res = bsxfun(@rdivide, nume, strength .* colScale(1) .* pooled + offset);
+else
+    res = zeros(size(nume));
+    for j = 1:size(nume, 2)
+        res(:, j) = nume(:, j) ./ (strength .* colScale(j) .* pooled + offset);
+    end
+end
@@ -0,0 +1,12 @@
+% deno = shNormalizationExpand(pooled, colScale)
+%
+% The full positions x neurons normalization signal deno*normwts from the
+% outputs of shNormalizationPool.
+
+function deno = shNormalizationExpand(pooled, colScale)
+
+if isempty(colScale)
+    deno = pooled;
+else
+    deno = pooled * colScale;
+end
@@ -0,0 +1,37 @@
+% [pooled, colScale] = shNormalizationPool(deno, normwts)
+%
+% Pool the normalization signal deno (positions x pool neurons) with the
+% weights normwts (pool neurons x normalized neurons), i.e. deno*normwts.
+%
+% The tuned normalization weights are currently uniform, which makes every
+% column of deno*normwts the same. More generally, whenever normwts is rank
+% one, normwts = u*v, every column of deno*normwts is a multiple of the
+% single pooled vector deno*u. In that case pooled is that positions x 1
+% vector and colScale is the 1 x (normalized neurons) row v, so that
+% deno*normwts = pooled*colScale; the full product is never formed. For
+% any other normwts, pooled = deno*normwts and colScale is empty.
+%
+% Use shNormalizationDivide to divide by the pooled signal, and
+% shNormalizationExpand to get the full deno*normwts when it is needed.
+
+function [pooled, colScale] = shNormalizationPool(deno, normwts)
+
+colScale = [];
+k = find(any(normwts ~= 0, 1), 1);
+if isempty(k)
+    pooled = zeros(size(deno, 1), size(normwts, 2));
+    return
+end
+
+u = normwts(:, k);
+v = (u' * normwts) ./ (u' * u);
+if max(max(abs(normwts - u*v))) <= 1e-12 .* max(abs(normwts(:)))
+    colScale = v;
+    if all(u == u(1))
+        pooled = u(1) .* sum(deno, 2);
+    else
+        pooled = tallSkinnyMult(deno, u);
+    end
+else
+    pooled = tallSkinnyMult(deno, normwts);
+end
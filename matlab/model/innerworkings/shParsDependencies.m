@@ -0,0 +1,56 @@
+% deps = shParsDependencies
+%
+% Which model stages read each field of the pars structure.
+%
+% deps is an Nx2 cell array. The first column names a field of pars (or a
+% subfield of pars.scaleFactors, written 'scaleFactors.v1Linear' etc.);
+% the second is a cell array of the stage names, as used by
+% shModelStageList and shModelRunStage, that read that field. A field that
+% no stage reads directly has an empty list: pars.mtBaseline, for example,
+% only acts on the model through pars.mtAlpha and the scale factors that
+% shParsScaleFactors derives from it.
+%
+% Keep this list in step with the stage functions: a field that is read by
+% a stage but missing here is treated by shSessionRun as read by the first
+% stage, so it is never wrong, just slow.
+
+function deps = shParsDependencies
+
+deps = {
+    'nScales',                              {'v1Linear', 'v1LinearRectified', 'v1Blur', 'v1Normalization', 'mtLinear', ...
+                                             'mtPreThresholdBlur', 'mtPostThresholdBlur', 'mtNormalization'}
+    'v1SpatialFilters',                     {'v1Linear', 'v1LinearRectified'}
+    'v1TemporalFilters',                    {'v1Linear', 'v1LinearRectified'}
+    'v1PopulationDirections',               {'v1Linear', 'v1LinearRectified', 'v1FullWaveRectification', 'v1Blur', ...
+                                             'v1Normalization', 'mtLinear', 'mtPreThresholdBlur', ...
+                                             'mtPostThresholdBlur'}
+    'v1Baseline',                           {}
+    'v1ComplexFilter',                      {'v1Blur'}
+    'v1NormalizationType',                  {'v1Normalization', 'mtPreThresholdBlur', 'mtPostThresholdBlur'}
+    'v1NormalizationSpatialFilter',         {'v1Normalization'}
+    'v1NormalizationTemporalFilter',        {'v1Normalization'}
+    'v1C50',                                {'v1Normalization'}
+    'mtPopulationVelocities',               {'mtLinear', 'mtPreThresholdBlur', 'mtPostThresholdBlur', ...
+                                             'mtNormalization'}
+    'mtSpatialPoolingBeforeThreshold',      {'mtPreThresholdBlur', 'mtPostThresholdBlur'}
+    'mtSpatialPoolingFilter',               {'mtPreThresholdBlur', 'mtPostThresholdBlur'}
+    'mtNormalizationType',                  {'mtNormalization'}
+    'mtNormalizationSpatialFilter',         {'mtNormalization'}
+    'mtNormalizationTemporalFilter',        {'mtNormalization'}
+    'mtC50',                                {'mtNormalization'}
+    'mtBaseline',                           {}
+    'mtExponent',                           {'halfWaveRectification'}
+    'mtAlpha',                              {'halfWaveRectification'}
+    'temporaryPopVec',                      {}
+    'scaleFactors.v1Linear',                {'v1Linear', 'v1LinearRectified'}
+    'scaleFactors.v1FullWaveRectified',     {'v1LinearRectified', 'v1FullWaveRectification'}
+    'scaleFactors.v1Blur',                  {'v1Blur'}
+    'scaleFactors.v1NormalizationPopulationK', {'v1Normalization'}
+    'scaleFactors.v1NormalizationStrength', {'v1Normalization'}
+    'scaleFactors.v1Complex',               {'v1Normalization'}
+    'scaleFactors.mtLinear',                {'mtLinear'}
+    'scaleFactors.mtHalfWaveRectification', {'halfWaveRectification'}
+    'scaleFactors.mtNormalization',         {'mtNormalization'}
+    'scaleFactors.mtNormalizationStrength', {'mtNormalization'}
+    'scaleFactors.mtPattern',               {'mtNormalization'}
+    };
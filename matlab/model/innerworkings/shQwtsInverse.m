@@ -0,0 +1,19 @@
+% qInv = shQwtsInverse(popdirs)     pinv(shQwts(popdirs)), cached
+%
+% The pseudo-inverse of the squared-filter interpolation weights of the V1
+% population, which every stage that steers V1 responses needs. popdirs is
+% normally pars.v1PopulationDirections, so the same matrix is asked for on
+% every call to shModel; it is computed once and kept until popdirs
+% changes.
+%
+% SEE ALSO: shQwts, shV1SteeringMatrix
+
+function qInv = shQwtsInverse(popdirs)
+
+persistent cachedDirs cachedInv
+
+if isempty(cachedInv) || ~isequal(popdirs, cachedDirs)
+    cachedInv = pinv(shQwts(popdirs));
+    cachedDirs = popdirs;
+end
+qInv = cachedInv;
@@ -0,0 +1,47 @@
+% reduced = shReduceResponse(shMatrix, ind, outputSpec)
+%
+% Reduce a matrix of model responses to a summary over space and/or time.
+%
+% shMatrix is a response matrix from shModel (pop, res, nume, ...) and ind
+% its index matrix. The reduction is taken over the first scale, the one
+% shGetNeuron and shGetSubPop read by default. outputSpec is one of:
+%   'full'          no reduction.
+%   'mean'          mean over space and time. 1 x N.
+%   'max'           maximum over space and time. 1 x N.
+%   'meanSpace'     mean over space at each time. T x N.
+%   'meanTime'      mean over time at each position. (Y*X) x N.
+%   'centerMean'    mean over time of the neuron at the center position,
+%                   i.e. mean(shGetNeuron(shMatrix, ind), 2)'. 1 x N.
+%   'centerMax'     maximum over time of the neuron at the center position.
+%                   1 x N.
+% Matrices that do not have one row per position (a scalar normalization
+% signal, or a matrix that has already been reduced) are returned
+% unchanged.
+
+function shMatrix = shReduceResponse(shMatrix, ind, outputSpec)
+
+if strcmp(outputSpec, 'full') || size(shMatrix, 1) ~= ind(end, 1)
+    return
+end
+
+nNeurons = size(shMatrix, 2);
+sz = ind(2, 2:4);
+shMatrix = reshape(shMatrix(1:ind(2, 1), :), [sz(1)*sz(2), sz(3), nNeurons]);
+center = floor(sz(1)./2) + 1 + floor(sz(2)./2).*sz(1);
+
+switch outputSpec
+    case 'mean'
+        shMatrix = reshape(mean(mean(shMatrix, 1), 2), [1 nNeurons]);
+    case 'max'
+        shMatrix = reshape(max(max(shMatrix, [], 1), [], 2), [1 nNeurons]);
+    case 'meanSpace'
+        shMatrix = reshape(mean(shMatrix, 1), [sz(3) nNeurons]);
+    case 'meanTime'
+        shMatrix = reshape(mean(shMatrix, 2), [sz(1)*sz(2) nNeurons]);
+    case 'centerMean'
+        shMatrix = reshape(mean(shMatrix(center, :, :), 2), [1 nNeurons]);
+    case 'centerMax'
+        shMatrix = reshape(max(shMatrix(center, :, :), [], 2), [1 nNeurons]);
+    otherwise
+        error([outputSpec, ' is not a recognized output specification.']);
+end
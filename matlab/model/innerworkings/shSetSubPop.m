@@ -29,7 +29,6 @@ end
 % indices = sub2ind(size(pop), n.*ones(size(indices)), indices);
 
 
-mRows = size(pop, 1);
-startIndex = (n-1)*mRows;
-destructiveMatrixWriteAtIndices(pop, subPop, startIndex);
-
+% the volume of subpopulation n at scale s is rows ind(s, 1)+1 to
+% ind(s+1, 1) of column n. pop is returned, not written in place.
+pop(ind(s, 1)+1:ind(s+1, 1), n) = subPop(:);
@@ -0,0 +1,12 @@
+% ind = shStackIndices(ind, n)
+%
+% The index matrix of n response matrices that share the index matrix ind,
+% stacked along their rows: the scales of the first, then those of the
+% second, and so on. shModel stacks the responses to the stimuli of a
+% batch this way (see shModelBatch), so every stage runs over the whole
+% batch at once, as if it were one stimulus with n times as many scales.
+
+function ind = shStackIndices(ind, n)
+
+blocks = repmat(ind(2:end, 2:4), n, 1);
+ind = [zeros(1, 4); cumsum(prod(blocks, 2)), blocks];
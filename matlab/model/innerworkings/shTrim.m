@@ -4,6 +4,9 @@
 % trimmer is a 3-vector contianing the number of pixels you want trimmed
 % off on both sides of each dimension. So you'll actually trim away twice
 % the number of pixels in trimmer.
+%
+% The trimmed block of every scale and neuron is copied in one strided
+% pass by the stridedTrim MEX function, without building an index vector.
 
 function [pop, ind] = shTrim(bigPop, bigInd, trimmer);
 
@@ -20,15 +23,6 @@ for i = 2:size(bigInd, 1)
 
     ind(i,1) = ind(i-1, 1) + prod(ind(i,(2:4)));
 end
-pop = zeros(ind(end, 1),size(bigPop, 2));
 
 % Trim down the population response
-w = [];
-for i = 1:size(bigInd, 1)-1
-    tmp = ones(bigInd(i+1, 2:end));
-    tmp(x+1:end-x, y+1:end-y, t+1:end-t) = 0; 
-    tmp = tmp(:);
-    w = [w, find(tmp)' + bigInd(i, 1)];
-end
-bigPop(w, :) = [];
-pop = bigPop;
+pop = stridedTrim(bigPop, bigInd, trimmer);
@@ -0,0 +1,20 @@
+% nAtATime = shTuneBatchSize(stimulusSize, pars, stageName, nNeurons, memoryBudget)
+%
+% The number of stimuli of size stimulusSize the tuning functions (shTune*)
+% pass to shModel at once, as one batch (see shModelBatch), when they
+% compute the responses of nNeurons neurons at stageName. They plot the
+% points computed so far after every batch.
+%
+% A batch holds the responses to all its stimuli at once, so it is as many
+% stimuli as shModelPlan predicts fit in memoryBudget bytes (DEFAULT =
+% 2^28), but never more than 8, so the plot is still redrawn as the
+% curve is computed.
+
+function nAtATime = shTuneBatchSize(stimulusSize, pars, stageName, nNeurons, memoryBudget)
+
+if nargin < 5
+    memoryBudget = 2^28;
+end
+
+plan = shModelPlan(stimulusSize, pars, stageName, nNeurons);
+nAtATime = max(1, min(8, floor(memoryBudget ./ plan.peakBytes)));
@@ -0,0 +1,94 @@
+% [yResponse, yBrute, maxDeviation] = shTuneDirectionCurve(makeStimulus, pars, stageName, neuron, xDirection, method, tolerance)
+%
+% The average response of a neuron to a stimulus moving in each of the
+% directions in xDirection. Used by the direction tuning functions.
+%
+% makeStimulus is a function handle that returns the stimulus moving in a
+% given direction. method is one of:
+%   'brute'     make a stimulus for every direction and run the model on
+%               them, a batch at a time.
+%   'steer'     make one stimulus, moving in the neuron's preferred
+%               direction, and run the model once for a set of rotated
+%               copies of the neuron, using the response of the neuron
+%               rotated to 2*p - x to the reference stimulus as the
+%               response of a neuron preferring p to direction x. Only the
+%               response weights change from one direction to the next, so
+%               the cost is that of a single stimulus.
+%   'check'     do both. yResponse is the steered curve and yBrute the
+%               brute-force one.
+%
+% The steered curve is an approximation. It would be exact if rotating the
+% stimulus and the neuron together left the response unchanged, but the
+% model only approximately has that symmetry: the stimulus is sampled on
+% the pixel grid, the V1 population has a fixed, discrete set of
+% directions (pars.v1PopulationDirections) and so does the MT population
+% that normalizes it (pars.mtPopulationVelocities). Random dot stimuli
+% differ from one direction to the next as well.
+%
+% For 'check', maxDeviation is the largest difference between the two
+% curves as a fraction of the peak brute-force response; it is NaN for the
+% other methods. 'check' stops with an error if it exceeds tolerance,
+% DEFAULT = 0.05 (5% of the peak response).
+
+function [yResponse, yBrute, maxDeviation] = shTuneDirectionCurve(makeStimulus, pars, stageName, neuron, xDirection, method, tolerance)
+
+if nargin < 7
+    tolerance = 0.05;
+end
+
+yBrute = [];
+maxDeviation = NaN;
+isLinear = strcmpi(stageName, 'v1lin');
+
+if any(strcmp(method, {'brute', 'check'}))
+    % run the stimuli through the model a batch at a time (see
+    % shModelBatch), so only one batch of them is held in memory.
+    thisStimulus = makeStimulus(xDirection(1));
+    stimSz = [size(thisStimulus, 1), size(thisStimulus, 2), size(thisStimulus, 3)];
+    nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+    yBrute = zeros(1, length(xDirection));
+    for first = 1:nAtATime:length(xDirection)
+        batch = first:min(first+nAtATime-1, length(xDirection));
+        stimuli = zeros([stimSz, length(batch)]);
+        for i = batch
+            stimuli(:, :, :, i-first+1) = makeStimulus(xDirection(i));
+        end
+
+        [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
+        if isLinear
+            res = sqrt(res.^2);
+        end
+        for i = batch
+            yBrute(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
+        end
+    end
+    yResponse = yBrute;
+end
+
+if any(strcmp(method, {'steer', 'check'}))
+    % one stimulus in the neuron's preferred direction, and one rotated copy
+    % of the neuron per direction.
+    rotated = repmat(neuron(1, :), length(xDirection), 1);
+    rotated(:, 1) = mod(2.*neuron(1) - xDirection(:), 2*pi);
+
+    if isLinear
+        [pop, ind, res] = shModel(makeStimulus(neuron(1)), pars, stageName, rotated);
+        res = shReduceResponse(sqrt(res.^2), ind, 'centerMean');
+    else
+        [pop, ind, res] = shModel(makeStimulus(neuron(1)), pars, stageName, rotated, 'centerMean');
+    end
+    yResponse = reshape(res, size(xDirection));
+end
+
+if strcmp(method, 'check')
+    maxDeviation = max(abs(yResponse - yBrute)) ./ max(abs(yBrute));
+    fprintf(1, 'Largest difference between steered and brute-force tuning: %g%% of the peak response\n', ...
+        100 .* maxDeviation);
+    if ~(maxDeviation <= tolerance)
+        error(['The steered tuning curve differs from the brute-force one by ', ...
+            num2str(100 .* maxDeviation), '% of the peak response, more than the tolerance of ', ...
+            num2str(100 .* tolerance), '%.']);
+    end
+elseif ~any(strcmp(method, {'brute', 'steer'}))
+    error([method, ' is not a recognized tuning method.']);
+end
@@ -0,0 +1,21 @@
+% steer = shV1SteeringMatrix(popdirs, resdirs)
+%
+% The matrix that steers squared V1 population responses to the responses
+% of the neurons in resdirs:
+%   res = pop * shV1SteeringMatrix(popdirs, resdirs);
+% which is pop * pinv(shQwts(popdirs))' * shQwts(resdirs)'. Tuning loops ask
+% for the same pair of direction sets over and over, so the last matrix
+% is kept and reused until either set changes.
+%
+% SEE ALSO: shQwts, shQwtsInverse
+
+function steer = shV1SteeringMatrix(popdirs, resdirs)
+
+persistent cachedPopdirs cachedResdirs cachedSteer
+
+if isempty(cachedSteer) || ~isequal(popdirs, cachedPopdirs) || ~isequal(resdirs, cachedResdirs)
+    cachedSteer = shQwtsInverse(popdirs)' * shQwts(resdirs)';
+    cachedPopdirs = popdirs;
+    cachedResdirs = resdirs;
+end
+steer = cachedSteer;
@@ -51,14 +51,11 @@ switch lower(stageName)
         t = pars.v1TemporalFilters;
         dims = dims + [size(s,1), size(s,1), size(t,1)] - 1;
 
-        if strcmp(pars.v1NormalizationType, 'untuned')
-            dims = dims + [15 15 0];
-        elseif strcmp(pars.v1NormalizationType, 'tuned1')
+        % only tuned normalization (see shModelV1Normalization) trims
+        if strcmp(pars.v1NormalizationType, 'tuned')
             s = pars.v1NormalizationSpatialFilter;
             t = pars.v1NormalizationTemporalFilter;
-            dims = dims + [length(s)-1, length(s)-1, size(t,1)-1];
-        elseif strcmp(pars.v1NormalizationType, 'tuned2')
-            % not supported yet
+            dims = dims + [length(s)-1, length(s)-1, length(t)-1];
         end
 
     case 'v1fullrect'
@@ -82,8 +79,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -98,8 +94,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -114,8 +109,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -135,8 +129,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -156,8 +149,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -182,8 +174,7 @@ switch lower(stageName)
         c = length(pars.v1ComplexFilter) - 1;
         dims = dims + [c c 0];
         
-        if strcmp(pars.v1NormalizationType, 'global')
-        else
+        if strcmp(pars.v1NormalizationType, 'tuned')
             nx = length(pars.v1NormalizationSpatialFilter) - 1;
             nt = length(pars.v1NormalizationTemporalFilter) - 1;
             dims = dims + [nx nx nt];
@@ -199,8 +190,7 @@ switch lower(stageName)
             dims = dims + [s s 0];
         end
         
-        if strcmp(pars.mtNormalizationType, 'global')
-        else
+        if strcmp(pars.mtNormalizationType, 'tuned')
             xSz = length(pars.mtNormalizationSpatialFilter) - 1;
             tSz = length(pars.mtNormalizationTemporalFilter) - 1;
             dims = dims + [xSz xSz tSz];
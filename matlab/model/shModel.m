@@ -1,8 +1,13 @@
-% [pop, ind, res] = shModel(stimulus, pars, stageName, additionalNeurons) Run the Simoncelli & Heeger model.
+% [pop, ind, res] = shModel(stimulus, pars, stageName, additionalNeurons, outputSpec) Run the Simoncelli & Heeger model.
 %
 % Required arguments:
 % stimulus          a 3D matrix that contains a stimulus. Its dimensions
-%                   must be [Y X T].
+%                   must be [Y X T]. To run several stimuli of the same
+%                   size at once, stack them into a 4D [Y X T N] matrix;
+%                   every response output then gains a third dimension
+%                   indexing the stimuli (pop(:, :, k) is the response to
+%                   stimulus(:, :, :, k)), and ind describes the
+%                   responses to a single stimulus. See shModelBatch.
 % pars              a parameters structure like the default parameter
 %                   structure generated by shPars.
 % stageName         the stage of the model whose output you want computed. 
@@ -24,6 +29,17 @@
 %                       ratio of temporal frequency to spatial frequency
 %                       (for V1 neurons). Direction is given in radians
 %                       with 0 = right; speed is given in pixels per frame.
+%                       Pass [] to request no additional neurons.
+% outputSpec            by default ('full') the responses of neurons at
+%                       every position and time are returned. If you only
+%                       need a summary, ask for it here and every response
+%                       output (pop, res, nume, deno, ...) is reduced to
+%                       it; the normalization stages reduce the responses
+%                       of additional neurons as they compute them, so the
+%                       full maps are never stored. Choices: 'mean', 'max',
+%                       'meanSpace', 'meanTime', 'centerMean', 'centerMax'.
+%                       See shReduceResponse for what each one returns.
+%                       IND still describes the unreduced responses.
 % 
 % Output:
 % pop       the responses of neurons in the population. Each row of pop
@@ -44,6 +60,15 @@ function varargout = shModel(varargin)
 stimulus = varargin{1};
 pars = varargin{2};
 stageName = varargin{3};
+additionalNeurons = [];
+outputSpec = 'full';
+if nargin > 3
+    additionalNeurons = varargin{4};
+end
+if nargin > 4
+    outputSpec = varargin{5};
+end
+hasRes = ~isempty(additionalNeurons);
 
 sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
 if any(sSz < shGetDims(pars, stageName))
@@ -51,217 +76,12 @@ if any(sSz < shGetDims(pars, stageName))
         stageName, ' stage.'];
     error(errString);
 end
-    
-switch lower(stageName)
-    case {'v1lin'}
-        if nargin > 3
-            [pop, ind, S, res] = shModelV1Linear(stimulus, pars, varargin{4});
-        else
-            [pop, ind, S] = shModelV1Linear(stimulus, pars);
-        end
-
-        varargout{1} = pop;
-        varargout{2} = ind;
-        varargout{3} = S;
-        if nargin > 3
-            varargout{3} = res;
-            varargout{4} = S;
-        end
-
-    case {'v1halfrect'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        if nargin > 3
-            [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, varargin{4});
-        else
-            [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-        
-    case {'v1simple'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
-        if nargin > 3
-            [pop, ind, nume, deno, res, resnume, resdeno] = shModelV1Normalization(pop, ind, pars, varargin{4});
-        else
-            [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        varargout{3} = nume;
-        varargout{4} = deno;
-        if nargin > 3
-            varargout{3} = res;
-            varargout{4} = nume;
-            varargout{5} = deno;
-            varargout{6} = resnume;
-            varargout{7} = resdeno;
-        end
-        
-    case {'v1fullrect'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        if nargin > 3
-            [pop, ind, res] = shModelFullWaveRectification(pop, ind, pars, varargin{4});
-        else
-            [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-        
-    case {'v1blur'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        if nargin > 3
-            [pop, ind, res] = shModelV1Blur(pop, ind, pars, varargin{4});
-        else
-            [pop, ind] = shModelV1Blur(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-        
-    case {'v1complex'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);
-        if nargin > 3
-            [pop, ind, nume, deno, res, resnume, resdeno] = shModelV1Normalization(pop, ind, pars, varargin{4});
-        else
-            [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        varargout{3} = nume;
-        varargout{4} = deno;
-        if nargin > 3
-            varargout{3} = res;
-            varargout{4} = nume;
-            varargout{5} = deno;
-            varargout{6} = resnume;
-            varargout{7} = resdeno;
-        end
 
-    case {'mtlin'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);
-        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        
-        if nargin > 3
-            [pop, ind, res] = shModelMtLinear(pop, ind, pars, varargin{4});
-        else
-            [pop, ind] = shModelMtLinear(pop, ind, pars);
-        end
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-        
-    case {'mtprepool'} 
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);
-        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        
-        if nargin > 3
-            [pop, ind, res] = shModelMtLinear(pop, ind, pars, varargin{4});
-            [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
-        else
-            [pop, ind] = shModelMtLinear(pop, ind, pars);
-            [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
-        end
-        
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-
-    case {'mthalfrect'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);
-        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        
-        if nargin > 3
-            [pop, ind, res] = shModelMtLinear(pop, ind, pars, varargin{4});
-            [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
-            [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res);
-        else
-            [pop, ind] = shModelMtLinear(pop, ind, pars);
-            [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
-            [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
-        end
-        
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-
-    case {'mtpostpool'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);
-        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-        
-        if nargin > 3
-            [pop, ind, res] = shModelMtLinear(pop, ind, pars, varargin{4});
-            [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
-            [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res);
-            [pop, ind, res] = shModelMtPostThresholdBlur(pop, ind, pars, res);
-        else
-            [pop, ind] = shModelMtLinear(pop, ind, pars);
-            [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
-            [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
-            [pop, ind] = shModelMtPostThresholdBlur(pop, ind, pars);
-        end
-        
-        varargout{1} = pop;
-        varargout{2} = ind;
-        if nargin > 3
-            varargout{3} = res;
-        end
-        
-    case {'mtpattern'}
-        [pop, ind] = shModelV1Linear(stimulus, pars);
-        [pop, ind] = shModelFullWaveRectification(pop, ind, pars);
-        [pop, ind] = shModelV1Blur(pop, ind, pars);           % 160
-        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
-
-        
-        if nargin > 3
-            [pop, ind, res] = shModelMtLinear(pop, ind, pars, varargin{4});
-            [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
-            [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res);
-            [pop, ind, res] = shModelMtPostThresholdBlur(pop, ind, pars, res);
-            [pop, ind, nume, deno, res, resnume, resdeno] = shModelMtNormalization(pop, ind, pars, res, varargin{4});
-        else
-            [pop, ind] = shModelMtLinear(pop, ind, pars);
-            [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
-            [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
-            [pop, ind] = shModelMtPostThresholdBlur(pop, ind, pars);
-            [pop, ind, nume, deno] = shModelMtNormalization(pop, ind, pars);
-        end
-        
-        varargout{1} = pop;
-        varargout{2} = ind;
-        varargout{3} = nume;
-        varargout{4} = deno;
-        if nargin > 3           
-            varargout{3} = res;
-            varargout{4} = nume;
-            varargout{5} = deno;
-            varargout{6} = resnume;
-            varargout{7} = resdeno;
-        end    
+if size(stimulus, 4) > 1
+    varargout = shModelBatch(stimulus, pars, stageName, additionalNeurons, outputSpec);
+    return
 end
+
+[pop, ind, res, aux, stage] = shModelRunStages(stimulus, pars, stageName, ...
+    additionalNeurons, outputSpec);
+varargout = shModelPackOutputs(stage, pop, ind, res, aux, hasRes, outputSpec);
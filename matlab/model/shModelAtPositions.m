@@ -0,0 +1,138 @@
+% [pop, ind, ...] = shModelAtPositions(stimulus, pars, stageName, neuronPositions, additionalNeurons)
+%
+% Run the Simoncelli & Heeger model only for neurons at given spatial
+% positions.
+%
+% shModel computes the responses of neurons centered on every spatial
+% position the stimulus allows, even though shGetNeuron (and every shTune
+% function) only reads one of them. The response at one position depends
+% only on the stimulus inside its receptive field footprint: the
+% cumulative spatial support of all the model stages, as reported by
+% shGetDims. shModelAtPositions crops that footprint out of the stimulus
+% for each requested position and runs the model on it, so only the
+% voxels inside each position's cone are ever computed. When the requested
+% positions are so close together that their footprints mostly overlap,
+% the model is run once on the bounding box of all the footprints instead.
+%
+% Required arguments:
+% stimulus          a 3D matrix that contains a stimulus. Its dimensions
+%                   must be [Y X T].
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars. With pars.nScales > 1
+%                   or 'global' normalization the responses are not
+%                   spatially local, so the whole stimulus is computed
+%                   and the requested positions are read from scale 1.
+% stageName         the stage of the model whose output you want computed.
+% neuronPositions   a Kx2 matrix. Each row is the spatial position of a
+%                   neuron in [Y X] coordinates, in the same convention as
+%                   shGetNeuron: [0 0] is the position closest to the
+%                   center of the full shModel output.
+%
+% Optional arguments:
+% additionalNeurons the tuning of additional neurons, as for shModel.
+%                   DEFAULT = [] (none).
+%
+% Output:
+% the same outputs as shModel, in the same order, except that the neurons
+% at the K requested positions are stacked along the Y dimension: IND
+% describes a [K 1 T] volume. The k-th position is therefore
+% shGetNeuron(res, ind, n, 1, [k - (floor(K/2)+1), 0]). With a single
+% position, shGetNeuron(res, ind) returns it directly.
+%
+% SEE ALSO: shModel, shGetNeuron, shGetDims
+
+function varargout = shModelAtPositions(varargin)
+
+additionalNeurons = 'default';
+
+                    stimulus = varargin{1};
+                    pars = varargin{2};
+                    stageName = varargin{3};
+                    neuronPositions = varargin{4};
+if nargin >= 5;     additionalNeurons = varargin{5};        end
+
+if strcmp(additionalNeurons, 'default');    additionalNeurons = [];         end
+
+% DONE PARSING INPUTS
+
+sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
+dims = shGetDims(pars, stageName);
+if any(sSz < dims)
+    error(['Stimulus is not large enough for computation of the ', ...
+        stageName, ' stage.']);
+end
+halo = dims(1:2) - 1;
+outSz = sSz(1:2) - halo;
+
+% positions in the full output, which are also the top left corners of
+% the receptive field footprints in the stimulus.
+nPositions = size(neuronPositions, 1);
+py = floor(outSz(1)./2) + 1 + neuronPositions(:, 1);
+px = floor(outSz(2)./2) + 1 + neuronPositions(:, 2);
+if any(py < 1 | py > outSz(1) | px < 1 | px > outSz(2))
+    error('Requested neuron positions lie outside the output of the model.');
+end
+
+nOut = max(nargout, 2);
+hasRes = ~isempty(additionalNeurons);
+
+% decide whether it is cheaper to compute each footprint separately or
+% the bounding box of all of them at once.
+isLocal = pars.nScales == 1 && ~strcmp(pars.v1NormalizationType, 'global') ...
+    && ~strcmp(pars.mtNormalizationType, 'global');
+boxY = min(py):max(py);
+boxX = min(px):max(px);
+boxCost = (length(boxY) + halo(1)) .* (length(boxX) + halo(2));
+footprintCost = nPositions .* prod(halo + 1);
+
+if ~isLocal
+    crops = {[1, sSz(1), 1, sSz(2)]};
+    pick = [py, px];
+    whichCrop = ones(nPositions, 1);
+elseif boxCost <= footprintCost
+    crops = {[boxY(1), boxY(end)+halo(1), boxX(1), boxX(end)+halo(2)]};
+    pick = [py - boxY(1) + 1, px - boxX(1) + 1];
+    whichCrop = ones(nPositions, 1);
+else
+    crops = cell(nPositions, 1);
+    for k = 1:nPositions
+        crops{k} = [py(k), py(k)+halo(1), px(k), px(k)+halo(2)];
+    end
+    pick = ones(nPositions, 2);
+    whichCrop = (1:nPositions)';
+end
+
+results = cell(length(crops), 1);
+for c = 1:length(crops)
+    r = crops{c};
+    cropOut = cell(1, nOut);
+    if hasRes
+        [cropOut{:}] = shModel(stimulus(r(1):r(2), r(3):r(4), :), pars, stageName, additionalNeurons);
+    else
+        [cropOut{:}] = shModel(stimulus(r(1):r(2), r(3):r(4), :), pars, stageName);
+    end
+    results{c} = cropOut;
+end
+
+% gather the requested positions from the first scale. Outputs with one
+% row per position are gathered; anything else (e.g. a scalar
+% normalization signal) is passed through from the first crop.
+nT = results{1}{2}(2, 4);
+ind = [0 0 0 0; nPositions*nT, nPositions, 1, nT];
+varargout = results{1};
+varargout{2} = ind;
+for o = [1, 3:nOut]
+    cropInd = results{1}{2};
+    if size(results{1}{o}, 1) ~= cropInd(end, 1)
+        continue
+    end
+    nNeurons = size(results{1}{o}, 2);
+    gathered = zeros(nPositions, 1, nT, nNeurons);
+    for k = 1:nPositions
+        cropInd = results{whichCrop(k)}{2};
+        tmp = results{whichCrop(k)}{o}(1:cropInd(2, 1), :);
+        tmp = reshape(tmp, [cropInd(2, 2:4), nNeurons]);
+        gathered(k, 1, :, :) = tmp(pick(k, 1), pick(k, 2), :, :);
+    end
+    varargout{o} = reshape(gathered, [ind(end, 1), nNeurons]);
+end
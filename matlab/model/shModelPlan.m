@@ -0,0 +1,195 @@
+% [plan, chunkSize] = shModelPlan(stimulusSize, pars, stageName, nExtraNeurons, memoryBudget, residentBytes)
+%
+% Predict the memory use and running time of shModel, stage by stage,
+% from the size of the stimulus and the parameters alone, and work out how
+% many additional neurons can be computed at once within a memory budget.
+%
+% Every stage of the model trims a known amount off the edges of its input
+% (see shGetDims) and produces a known number of channels, so the size of
+% every intermediate matrix follows from the stimulus size and the filter
+% lengths. The peak memory of a stage is taken to be the matrices it holds
+% at once: its input, its output and, for the normalization stages, the
+% numerator and denominator. The running time is estimated from the
+% number of multiply-adds of the filtering, steering and pooling, at
+% flopRate operations per second. Both are estimates, meant for choosing
+% chunk sizes, not exact accounts.
+%
+% Required arguments:
+% stimulusSize      the size [Y X T] of the stimulus.
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars.
+% stageName         the stage of the model whose output is wanted, as for
+%                   shModel.
+%
+% Optional arguments:
+% nExtraNeurons     the number of additional neurons (the additionalNeurons
+%                   argument of shModel). DEFAULT = 0.
+% memoryBudget      the number of bytes the model may use at once.
+%                   DEFAULT = 2^28 (256 MB).
+% residentBytes     the number of bytes of the budget the caller already
+%                   holds, e.g. responses it keeps while the model runs
+%                   (see shMtVelocityField). DEFAULT = 0.
+%
+% Output:
+% plan              a structure with fields
+%                   stages: one entry per stage (see shModelStageList) with
+%                       fields name, dims (the nScales x 3 sizes of its
+%                       output), positions (the number of rows of its
+%                       output), nChannels (the number of columns of its
+%                       population output), bytes (peak bytes without
+%                       additional neurons), bytesPerNeuron (extra peak
+%                       bytes for each additional neuron), flops and
+%                       flopsPerNeuron.
+%                   peakBytes: the predicted peak memory use, in bytes,
+%                       with nExtraNeurons additional neurons, including
+%                       residentBytes.
+%                   seconds: the predicted running time, in seconds, with
+%                       nExtraNeurons additional neurons.
+% chunkSize         the number of additional neurons that can be computed
+%                   in one call to shModel within memoryBudget (at least 1,
+%                   and no more than nExtraNeurons).
+%
+% Example of use:
+% pars = shPars;
+% [plan, chunkSize] = shModelPlan(shGetDims(pars, 'mtPattern', [1 1 31]), pars, 'mtPattern', 1000);
+% fprintf('%.0f MB, %.1f s, %d neurons at a time\n', plan.peakBytes/2^20, plan.seconds, chunkSize);
+%
+% SEE ALSO: shGetDims, shModelStageList, shMtVelocityField, shV1PopulationResponse
+
+function [plan, chunkSize] = shModelPlan(varargin)
+
+nExtraNeurons = 'default';
+memoryBudget = 'default';
+residentBytes = 'default';
+
+                    stimulusSize = varargin{1};
+                    pars = varargin{2};
+                    stageName = varargin{3};
+if nargin >= 4;     nExtraNeurons = varargin{4};            end
+if nargin >= 5;     memoryBudget = varargin{5};             end
+if nargin >= 6;     residentBytes = varargin{6};            end
+
+if strcmp(nExtraNeurons, 'default');        nExtraNeurons = 0;              end
+if strcmp(memoryBudget, 'default');         memoryBudget = 2^28;            end
+if strcmp(residentBytes, 'default');        residentBytes = 0;              end
+
+% DONE PARSING INPUTS
+
+flopRate = 1e9;         % multiply-adds per second assumed for the estimate
+dbl = 8;                % bytes per double
+
+stages = shModelStageList(stageName);
+nV1 = size(pars.v1PopulationDirections, 1);
+nMt = size(pars.mtPopulationVelocities, 1);
+fsz = size(pars.v1SpatialFilters, 1);
+
+% the additional neurons are computed from the last stage that steers its
+% responses from the population on, as in shModel.
+steeringStages = {'v1Linear', 'v1LinearRectified', 'v1FullWaveRectification', 'v1Blur', ...
+    'v1Normalization', 'mtLinear'};
+firstResStage = find(ismember(stages, steeringStages), 1, 'last');
+
+ind = shModelV1SeparablePlan(stimulusSize, pars);
+dims = ind(2:end, 2:4);
+stimulusVoxels = prod(stimulusSize);
+nChannels = 1;
+
+plan.stages = struct('name', stages, 'dims', [], 'positions', 0, 'nChannels', 0, ...
+    'bytes', 0, 'bytesPerNeuron', 0, 'flops', 0, 'flopsPerNeuron', 0);
+for i = 1:length(stages)
+    rowsIn = sum(prod(dims, 2));
+    colsIn = nChannels;
+    trim = [0 0 0];
+    nNumeDeno = 0;          % extra full-size outputs (nume and deno)
+    switch stages{i}
+        case {'v1Linear', 'v1LinearRectified'}
+            nChannels = nV1;
+            rows = rowsIn;
+            % one temporal, then 10 y and 10 x passes of length fsz, and
+            % the steering of the 10 separable responses
+            flops = 2*fsz*rows*(4 + 10 + 10) + 2*rows*10*nV1;
+            bytes = dbl*(stimulusVoxels + rows*(10 + nV1));
+            flopsPerNeuron = 2*rows*10;
+        case {'v1FullWaveRectification', 'halfWaveRectification'}
+            flops = 3*rowsIn*colsIn;
+            bytes = dbl*2*rowsIn*colsIn;
+            flopsPerNeuron = 3*rowsIn;
+        case 'v1Blur'
+            c = length(pars.v1ComplexFilter);
+            trim = [c-1, c-1, 0];
+            flops = 2*2*c*rowsIn*colsIn;
+            flopsPerNeuron = 2*2*c*rowsIn;
+        case 'v1Normalization'
+            if strcmp(pars.v1NormalizationType, 'tuned')
+                nx = length(pars.v1NormalizationSpatialFilter);
+                nt = length(pars.v1NormalizationTemporalFilter);
+                trim = [nx-1, nx-1, nt-1];
+            end
+            nNumeDeno = 2;
+            flops = 2*rowsIn*colsIn*(2*sum(trim(1:2)) + trim(3) + 3 + colsIn);
+            flopsPerNeuron = 2*rowsIn*(colsIn + 3);
+        case 'mtLinear'
+            nChannels = nMt;
+            flops = 2*rowsIn*colsIn*nMt;
+            flopsPerNeuron = 2*rowsIn*colsIn;
+        case {'mtPreThresholdBlur', 'mtPostThresholdBlur'}
+            before = strcmp(stages{i}, 'mtPreThresholdBlur');
+            if pars.mtSpatialPoolingBeforeThreshold == before
+                s = length(pars.mtSpatialPoolingFilter);
+                trim = [s-1, s-1, 0];
+            end
+            flops = 2*2*trim(1)*rowsIn*colsIn;
+            flopsPerNeuron = 2*2*trim(1)*rowsIn;
+        case 'mtNormalization'
+            if strcmp(pars.mtNormalizationType, 'tuned')
+                nx = length(pars.mtNormalizationSpatialFilter);
+                nt = length(pars.mtNormalizationTemporalFilter);
+                trim = [nx-1, nx-1, nt-1];
+            end
+            nNumeDeno = 2;
+            flops = 2*rowsIn*colsIn*(2*sum(trim(1:2)) + trim(3) + 3);
+            flopsPerNeuron = 2*rowsIn*3;
+        otherwise
+            error([stages{i}, ' is not a recognized model stage.']);
+    end
+
+    dims = bsxfun(@minus, dims, trim);
+    rows = sum(prod(dims, 2));
+    if ~any(strcmp(stages{i}, {'v1Linear', 'v1LinearRectified', 'v1FullWaveRectification', ...
+            'halfWaveRectification'}))
+        bytes = dbl*(rowsIn*colsIn + (1 + nNumeDeno)*rows*nChannels);
+    end
+
+    % before the additional neurons are computed they cost nothing; after,
+    % each one holds a column of the input and of every output.
+    bytesPerNeuron = 0;
+    if i > firstResStage
+        bytesPerNeuron = dbl*(rowsIn + (1 + nNumeDeno)*rows);
+    elseif i == firstResStage
+        bytesPerNeuron = dbl*(1 + nNumeDeno)*rows;
+    else
+        flopsPerNeuron = 0;
+    end
+
+    plan.stages(i).dims = dims;
+    plan.stages(i).positions = rows;
+    plan.stages(i).nChannels = nChannels;
+    plan.stages(i).bytes = bytes;
+    plan.stages(i).bytesPerNeuron = bytesPerNeuron;
+    plan.stages(i).flops = flops;
+    plan.stages(i).flopsPerNeuron = flopsPerNeuron;
+end
+
+bytes = [plan.stages.bytes];
+bytesPerNeuron = [plan.stages.bytesPerNeuron];
+plan.peakBytes = residentBytes + max(bytes + nExtraNeurons.*bytesPerNeuron);
+plan.seconds = sum([plan.stages.flops] + nExtraNeurons.*[plan.stages.flopsPerNeuron]) ./ flopRate;
+
+% the most additional neurons every stage can hold within the budget
+chunkSize = max(nExtraNeurons, 1);
+perNeuron = bytesPerNeuron > 0;
+if any(perNeuron)
+    fits = floor((memoryBudget - residentBytes - bytes(perNeuron)) ./ bytesPerNeuron(perNeuron));
+    chunkSize = min(chunkSize, min(fits));
+end
+chunkSize = max(chunkSize, 1);
@@ -0,0 +1,128 @@
+% [pop, ind, ...] = shModelTiled(stimulus, pars, stageName, additionalNeurons, tileSize)
+%
+% Run the Simoncelli & Heeger model on a large stimulus by splitting it
+% into spatial tiles that are computed in parallel.
+%
+% Every stage of the model only looks at a limited spatial neighborhood, so
+% the output of shModel at one position depends only on the part of the
+% stimulus within the cumulative spatial support of all the stages, which
+% is what shGetDims reports. shModelTiled splits the output positions into
+% tiles of size tileSize, gives each tile a halo of stimulus equal to that
+% support, runs shModel on each tile in a parfor loop and stitches the
+% tiles back into the standard pop/ind layout. The result is the same as
+% calling shModel on the whole stimulus.
+%
+% The tiles run on whatever parallel pool is open; if there is none (or
+% the Parallel Computing Toolbox is not installed) they run one after
+% another. For many-core machines a thread pool works best:
+% parpool('threads').
+%
+% Required arguments:
+% stimulus          a 3D matrix that contains a stimulus. Its dimensions
+%                   must be [Y X T].
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars. Only pars.nScales = 1
+%                   and spatially local normalization types ('tuned',
+%                   'off') are supported.
+% stageName         the stage of the model whose output you want computed.
+%
+% Optional arguments:
+% additionalNeurons the tuning of additional neurons, as for shModel.
+%                   DEFAULT = [] (none).
+% tileSize          the size of each output tile in [Y X] coordinates.
+%                   DEFAULT = [128 128].
+%
+% Output:
+% the same outputs as shModel, in the same order.
+%
+% SEE ALSO: shModel, shGetDims
+
+function varargout = shModelTiled(varargin)
+
+additionalNeurons = 'default';
+tileSize = 'default';
+
+                    stimulus = varargin{1};
+                    pars = varargin{2};
+                    stageName = varargin{3};
+if nargin >= 4;     additionalNeurons = varargin{4};        end
+if nargin >= 5;     tileSize = varargin{5};                 end
+
+if strcmp(additionalNeurons, 'default');    additionalNeurons = [];         end
+if strcmp(tileSize, 'default');             tileSize = [128 128];           end
+
+% DONE PARSING INPUTS
+
+if pars.nScales ~= 1
+    error('Tiled computation only supports pars.nScales = 1.');
+end
+if strcmp(pars.v1NormalizationType, 'global') || strcmp(pars.mtNormalizationType, 'global')
+    error('Global normalization pools over the whole stimulus and cannot be tiled.');
+end
+
+sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
+dims = shGetDims(pars, stageName);
+if any(sSz < dims)
+    error(['Stimulus is not large enough for computation of the ', ...
+        stageName, ' stage.']);
+end
+halo = dims(1:2) - 1;
+outSz = sSz(1:2) - halo;
+
+% the output positions covered by each tile
+yStarts = 1:tileSize(1):outSz(1);
+xStarts = 1:tileSize(2):outSz(2);
+[yStarts, xStarts] = ndgrid(yStarts, xStarts);
+yStarts = yStarts(:);
+xStarts = xStarts(:);
+yEnds = min(yStarts + tileSize(1) - 1, outSz(1));
+xEnds = min(xStarts + tileSize(2) - 1, outSz(2));
+nTiles = length(yStarts);
+
+nOut = max(nargout, 2);
+hasRes = ~isempty(additionalNeurons);
+tiles = cell(nTiles, 1);
+parfor k = 1:nTiles
+    tileStimulus = stimulus(yStarts(k):yEnds(k)+halo(1), xStarts(k):xEnds(k)+halo(2), :);
+    tileOut = cell(1, nOut);
+    if hasRes
+        [tileOut{:}] = shModel(tileStimulus, pars, stageName, additionalNeurons);
+    else
+        [tileOut{:}] = shModel(tileStimulus, pars, stageName);
+    end
+    tiles{k} = tileOut;
+end
+
+% each tile must cover exactly its output positions; otherwise the halo
+% taken from shGetDims does not match the trimming of the stages.
+for k = 1:nTiles
+    tileSz = tiles{k}{2}(end, 2:3);
+    if any(tileSz ~= [yEnds(k)-yStarts(k)+1, xEnds(k)-xStarts(k)+1])
+        error(['Tile ', num2str(k), ' of the ', stageName, ' stage is ', ...
+            mat2str(tileSz), ' instead of ', ...
+            mat2str([yEnds(k)-yStarts(k)+1, xEnds(k)-xStarts(k)+1]), ...
+            '; shGetDims does not match the stages.']);
+    end
+end
+
+% stitch the tiles together. Outputs with one row per position are
+% stitched; anything else (e.g. a scalar normalization signal) is the same
+% for every tile.
+nT = tiles{1}{2}(end, 4);
+ind = [0 0 0 0; outSz(1)*outSz(2)*nT, outSz(1), outSz(2), nT];
+varargout = tiles{1};
+varargout{2} = ind;
+for o = [1, 3:nOut]
+    tileInd = tiles{1}{2};
+    if size(tiles{1}{o}, 1) ~= tileInd(end, 1)
+        continue
+    end
+    nNeurons = size(tiles{1}{o}, 2);
+    stitched = zeros(outSz(1), outSz(2), nT, nNeurons);
+    for k = 1:nTiles
+        tileInd = tiles{k}{2};
+        stitched(yStarts(k):yEnds(k), xStarts(k):xEnds(k), :, :) = ...
+            reshape(tiles{k}{o}, [tileInd(end, 2:4), nNeurons]);
+    end
+    varargout{o} = reshape(stitched, [ind(end, 1), nNeurons]);
+end
@@ -1,4 +1,4 @@
-% [populationResponse, vx, vy] = shMtPopulationResponse(stimulus, pars, yVelocities, xVelocities)
+% [populationResponse, vx, vy] = shMtPopulationResponse(stimulus, pars, yVelocities, xVelocities, memoryBudget)
 %
 % Compute the response of a large population of MT neurons to a stimulus.
 %
@@ -12,6 +12,11 @@
 % xVelocities       the preferred x-velocities of the MT neurons in the
 %                   large population.
 %
+% Optional arguments:
+% memoryBudget      the number of bytes the model may use at once. The
+%                   velocities are computed in chunks that fit in it (see
+%                   shModelPlan). DEFAULT = 2^28 (256 MB).
+%
 % Output:
 % populationResponse    a matrix containing the average response of each
 %                       neuron in the large population to the stimulus.
@@ -29,7 +34,11 @@
 % shShowMtPopulationResponse(populationResponse, vx, vy);
 
 
-function [populationResponse, vx, vy] = shMtPopulationResponse(stimulus, pars, yVelocities, xVelocities)
+function [populationResponse, vx, vy] = shMtPopulationResponse(stimulus, pars, yVelocities, xVelocities, memoryBudget)
+
+if nargin < 5
+    memoryBudget = 'default';
+end
 
 [vx, vy] = meshgrid(xVelocities, yVelocities);
 vy = flipud(vy);
@@ -37,27 +46,10 @@ mtDirections = atan3(vy, vx);
 mtSpeeds = sqrt(vx.^2 + vy.^2);
 mtVelocities = [mtDirections(:), mtSpeeds(:)];
 
-populationResponse = zeros(size(mtVelocities,1), 1);
-
-i = 0;
-while i < size(mtVelocities, 1)
-    j = min(i+255, size(mtVelocities, 1));
-    tmp = mtVelocities(i+1:j, :);
-
-    [pop, ind, res] = shModel(stimulus, pars, 'mtpattern', tmp);
-    
-    for k = 1:size(res, 2)
-        try
-        tmp = shGetSubPop(res, ind, k);
-        populationResponse(i+k, 1) = mean2(tmp);
-        catch
-            keyboard
-        end
-    end
-    
-    populationResponse(i+1:j, 1) = mean(shGetNeuron(res, ind), 2); 
-    i = j;
-end
+% V1 and the MT normalization pool are computed once; only the
+% time-averaged response of the center neuron is kept for each velocity.
+populationResponse = shMtVelocityField(stimulus, pars, mtVelocities, 'mtPattern', 'centerMean', memoryBudget);
+populationResponse = populationResponse';
 
 populationResponse = reshape(populationResponse, size(vx));
     
@@ -0,0 +1,145 @@
+% [res, ind] = shMtVelocityField(stimulus, pars, velocities, stageName, outputSpec, memoryBudget)
+%
+% Compute the responses of MT neurons tuned to an arbitrary, possibly very
+% dense, set of velocities.
+%
+% The linear response of any MT neuron is a fixed weighting (shMtWts) of
+% the 28 channels of the V1 population response, so neither V1 nor the
+% normalization pool of the MT population depends on which velocities are
+% asked for. shMtVelocityField runs the V1 stages and the MT population
+% once, then projects the V1 responses onto the requested velocities and
+% carries them through the remaining MT stages a chunk of velocities at a
+% time. The chunks are sized by shModelPlan so that the model fits in
+% memoryBudget bytes, and each chunk is reduced according to outputSpec
+% before the next is computed.
+%
+% Required arguments:
+% stimulus          a 3D matrix that contains a stimulus. Its dimensions
+%                   must be [Y X T].
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars.
+% velocities        a Kx2 matrix. Each row gives the preferred direction
+%                   (radians, 0 = right) and speed (pixels per frame) of an
+%                   MT neuron, as in the additionalNeurons argument of
+%                   shModel.
+%
+% Optional arguments:
+% stageName         the MT stage whose output you want computed: 'mtLin',
+%                   'mtPrePool', 'mtHalfRect', 'mtPostPool' or 'mtPattern'.
+%                   DEFAULT = 'mtPattern'.
+% outputSpec        the reduction applied to the responses, as for shModel
+%                   (see shReduceResponse). DEFAULT = 'centerMean'.
+% memoryBudget      the number of bytes the model may use at once (see
+%                   shModelPlan). DEFAULT = 2^28 (256 MB).
+%
+% Output:
+% res               the responses of the requested neurons, one column per
+%                   row of velocities, reduced according to outputSpec.
+% ind               the index matrix of the unreduced responses.
+%
+% Example of use:
+% pars = shPars;
+% stimulus = mkDots(shGetDims(pars, 'mtPattern', [1 1 31]), 0, 1);
+% [vx, vy] = meshgrid(linspace(-3, 3, 61));
+% velocities = [atan3(vy(:), vx(:)), sqrt(vx(:).^2 + vy(:).^2)];
+% res = shMtVelocityField(stimulus, pars, velocities);
+% imagesc(reshape(res, size(vx)));
+%
+% SEE ALSO: shModel, shMtPopulationResponse, shMtWts
+
+function [res, ind] = shMtVelocityField(varargin)
+
+stageName = 'default';
+outputSpec = 'default';
+memoryBudget = 'default';
+
+                    stimulus = varargin{1};
+                    pars = varargin{2};
+                    velocities = varargin{3};
+if nargin >= 4;     stageName = varargin{4};                end
+if nargin >= 5;     outputSpec = varargin{5};               end
+if nargin >= 6;     memoryBudget = varargin{6};             end
+
+if strcmp(stageName, 'default');            stageName = 'mtPattern';        end
+if strcmp(outputSpec, 'default');           outputSpec = 'centerMean';      end
+if strcmp(memoryBudget, 'default');         memoryBudget = 2^28;            end
+
+% DONE PARSING INPUTS
+
+sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
+if any(sSz < shGetDims(pars, stageName))
+    error(['Stimulus is not large enough for computation of the ', ...
+        stageName, ' stage.']);
+end
+
+stages = shModelStageList(stageName);
+mtStart = find(strcmp(stages, 'mtLinear'));
+if isempty(mtStart)
+    error([stageName, ' is not an MT stage.']);
+end
+hasNormalization = strcmp(stages{end}, 'mtNormalization');
+
+% the V1 population response, once.
+v1pop = stimulus;
+v1ind = [];
+for i = 1:mtStart-1
+    [v1pop, v1ind] = shModelRunStage(stages{i}, v1pop, v1ind, pars, [], [], false);
+end
+
+% the MT population response feeding the normalization pool, and for tuned
+% normalization its blurred normalization signal, once.
+isTuned = hasNormalization && strcmp(pars.mtNormalizationType, 'tuned');
+deno = [];
+if hasNormalization
+    mtPop = v1pop;
+    mtInd = v1ind;
+    for i = mtStart:length(stages)-1
+        [mtPop, mtInd] = shModelRunStage(stages{i}, mtPop, mtInd, pars, [], [], false);
+    end
+    if isTuned
+        [mtOut, normInd, nume, deno] = shModelMtNormalization(mtPop, mtInd, pars);
+        clear mtOut nume mtPop
+        normPop = [];
+    else
+        % the untuned normalizations compute their pool from the population
+        % as they normalize the chunk, so it is passed to every chunk.
+        normPop = mtPop;
+    end
+end
+
+% the requested velocities, a chunk at a time, as many as shModelPlan
+% predicts the MT stages can hold within what is left of the memory budget
+% once the V1 responses, and the population and normalization signal the
+% chunks are normalized against, are held.
+nVelocities = size(velocities, 1);
+residentBytes = 8.*numel(v1pop);
+if hasNormalization
+    residentBytes = residentBytes + 8.*(numel(normPop) + numel(deno));
+end
+[plan, chunkSize] = shModelPlan(sSz, pars, stageName, nVelocities, memoryBudget, residentBytes);
+for b = 1:chunkSize:nVelocities
+    cols = b:min(b+chunkSize-1, nVelocities);
+    chunk = (v1pop * shMtWts(velocities(cols, :), pars)') .* pars.scaleFactors.mtLinear;
+    ind = v1ind;
+
+    % the stages after mtLinear treat every column alike, so the chunk can
+    % go through them in place of the population. Tuned normalization
+    % reduces the chunk itself; only the chunk is normalized, against the
+    % signal computed above.
+    for i = mtStart+1:length(stages)
+        if strcmp(stages{i}, 'mtNormalization')
+            [normOut, ind, nume, normDeno, chunk] = shModelMtNormalization(normPop, mtInd, ...
+                pars, chunk, velocities(cols, :), outputSpec, deno);
+            clear normOut nume normDeno
+        else
+            [chunk, ind] = shModelRunStage(stages{i}, chunk, ind, pars, [], [], false);
+        end
+    end
+    if ~isTuned
+        chunk = shReduceResponse(chunk, ind, outputSpec);
+    end
+    if b == 1
+        res = zeros(size(chunk, 1), nVelocities);
+    end
+    res(:, cols) = chunk;
+end
@@ -0,0 +1,134 @@
+% engine = shOnlineInit(pars, frameSize, stageName, additionalNeurons)
+%
+% Set up the model for online, frame-by-frame computation.
+%
+% shModel needs the whole stimulus movie before it can run. shOnlineInit
+% instead returns an ENGINE structure that you feed one frame at a time
+% with shOnlinePush. The engine keeps a ring buffer in front of every stage
+% of the model that filters over time, each sized to that stage's temporal
+% support, so the work done for each new frame does not depend on how many
+% frames came before it.
+%
+% Required arguments:
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars. Only pars.nScales = 1 is
+%                   supported.
+% frameSize         the size of each frame of the stimulus in [Y X]
+%                   coordinates. It must be at least as large as the
+%                   spatial part of shGetDims(pars, stageName).
+%
+% Optional arguments:
+% stageName         the stage of the model whose output you want computed.
+%                   supported options: 'v1Complex', 'mtPattern'.
+%                   DEFAULT = 'mtPattern'.
+% additionalNeurons tuning of additional neurons not in the population, in
+%                   the same format as for shModel. DEFAULT = [] (none).
+%
+% Output:
+% engine            a structure holding the parameters and the ring
+%                   buffers. Pass it to shOnlinePush along with each new
+%                   frame.
+%
+% Example of use:
+% pars = shPars;
+% dims = shGetDims(pars, 'mtPattern', [1 1 60]);
+% s = mkDots(dims, 0, 1);
+% engine = shOnlineInit(pars, dims(1:2), 'mtPattern', [0 1]);
+% for t = 1:size(s, 3)
+%     [engine, pop, ind, res] = shOnlinePush(engine, s(:,:,t));
+% end
+%
+% SEE ALSO: shOnlinePush, shModel, shGetDims
+
+function engine = shOnlineInit(varargin)
+
+stageName = 'default';
+additionalNeurons = 'default';
+
+                    pars = varargin{1};
+                    frameSize = varargin{2};
+if nargin >= 3;     stageName = varargin{3};                end
+if nargin >= 4;     additionalNeurons = varargin{4};        end
+
+if strcmp(stageName, 'default');            stageName = 'mtPattern';        end
+if strcmp(additionalNeurons, 'default');    additionalNeurons = [];         end
+
+% DONE PARSING INPUTS
+
+stageName = lower(stageName);
+if ~any(strcmp(stageName, {'v1complex', 'mtpattern'}))
+    error(['Online computation of the ', stageName, ' stage is not supported.']);
+end
+if pars.nScales ~= 1
+    error('Online computation only supports pars.nScales = 1.');
+end
+
+frameSize = frameSize(1:2);
+dims = shGetDims(pars, stageName);
+if any(frameSize < dims(1:2))
+    error(['Frames are not large enough for computation of the ', ...
+        stageName, ' stage.']);
+end
+
+engine.pars = pars;
+engine.stageName = stageName;
+engine.frameSize = frameSize;
+engine.additionalNeurons = additionalNeurons;
+engine.nFramesPushed = 0;
+
+% Stage 1: the linear V1 filters, followed by the rectification and
+% spatial blur that only operate within a frame. Its buffer holds raw
+% stimulus frames.
+engine.stimulusBuffer = shOnlineRingBuffer(frameSize, ...
+    size(pars.v1TemporalFilters, 1), false);
+
+% Stage 2: V1 normalization, which pools over time. Its buffer holds the
+% blurred V1 population response for each frame.
+v1Dims = shGetDims(pars, 'v1blur');
+v1Sz = frameSize - v1Dims(1:2) + 1;
+engine.v1Size = v1Sz;
+engine.v1Buffer = shOnlineRingBuffer([prod(v1Sz), size(pars.v1PopulationDirections, 1)], ...
+    shOnlineTemporalSupport(pars.v1NormalizationType, pars.v1NormalizationTemporalFilter), true);
+
+% Stage 3: everything in MT up to normalization is computed within a frame;
+% MT normalization pools over time, so it gets its own buffers.
+if strcmp(stageName, 'mtpattern')
+    mtDims = shGetDims(pars, 'mtpostpool');
+    mtSz = frameSize - mtDims(1:2) + 1;
+    % shModelMtNormalization_Tuned pools over time with the spatial filter
+    mtLength = shOnlineTemporalSupport(pars.mtNormalizationType, ...
+        pars.mtNormalizationSpatialFilter);
+    engine.mtSize = mtSz;
+    engine.mtBuffer = shOnlineRingBuffer([prod(mtSz), size(pars.mtPopulationVelocities, 1)], mtLength, true);
+    engine.mtResBuffer = shOnlineRingBuffer([prod(mtSz), size(additionalNeurons, 1)], mtLength, true);
+end
+
+
+
+function n = shOnlineTemporalSupport(normalizationType, temporalFilter)
+
+if strcmp(normalizationType, 'tuned')
+    n = length(temporalFilter);
+else
+    n = 1;
+end
+
+
+
+% A ring buffer of nEntries entries of size entrySize. Each entry is kept
+% twice, nEntries slots apart, so that the newest nEntries entries can be
+% read in order as one contiguous block without reordering the buffer
+% (see shOnlinePush). Frames of the stimulus are stacked along the third
+% dimension; response matrices (stackRows) along the rows, the way
+% shModel stacks the frames of a response matrix.
+function buffer = shOnlineRingBuffer(entrySize, nEntries, stackRows)
+
+if stackRows
+    buffer.data = zeros([2*nEntries*entrySize(1), entrySize(2)]);
+else
+    buffer.data = zeros([entrySize(1), entrySize(2), 2*nEntries]);
+end
+buffer.stackRows = stackRows;
+buffer.nEntries = nEntries;
+buffer.next = 1;
+buffer.count = 0;
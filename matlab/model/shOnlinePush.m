@@ -0,0 +1,145 @@
+% [engine, pop, ind, res, nume, deno, resnume, resdeno] = shOnlinePush(engine, frame)
+%
+% Push the next frame of a stimulus through an online model engine.
+%
+% Each call runs the model only as far as the newest frame allows: the
+% stimulus frame is filtered by the V1 stages, the result is appended to
+% the ring buffer of the next stage that pools over time, and so on. Once
+% every buffer has filled up, each call returns the responses for the
+% newest valid time step. Until then the outputs are empty.
+%
+% Required arguments:
+% engine            the ENGINE structure returned by shOnlineInit or by a
+%                   previous call to shOnlinePush.
+% frame             the next frame of the stimulus, a 2D matrix of size
+%                   engine.frameSize.
+%
+% Output:
+% engine            the updated engine. Pass it to the next call.
+% pop, ind, ...     the responses for the newest time step, in the same
+%                   format and order as the outputs of shModel for
+%                   engine.stageName. The T dimension of IND is 1. All
+%                   outputs are empty while the engine is still filling
+%                   its buffers.
+%
+% SEE ALSO: shOnlineInit, shModel
+
+function [engine, varargout] = shOnlinePush(engine, frame)
+
+pars = engine.pars;
+resNeurons = engine.additionalNeurons;
+hasRes = ~isempty(resNeurons);
+nOut = 4;
+if hasRes
+    nOut = 7;
+end
+varargout = cell(1, nOut);
+
+if any([size(frame, 1), size(frame, 2)] ~= engine.frameSize)
+    error('Frame size does not match the size the engine was initialized with.');
+end
+engine.nFramesPushed = engine.nFramesPushed + 1;
+
+% Stage 1: linear V1 filters, rectification and blur on the newest frames.
+engine = shOnlineRingPush(engine, 'stimulusBuffer', frame);
+if engine.stimulusBuffer.count < engine.stimulusBuffer.nEntries
+    return
+end
+stimulus = shOnlineRingWindow(engine.stimulusBuffer);
+[pop, ind] = shModelV1LinearRectified(stimulus, pars);
+[pop, ind] = shModelV1Blur(pop, ind, pars);
+
+% Stage 2: V1 normalization over the buffered V1 responses.
+engine = shOnlineRingPush(engine, 'v1Buffer', pop);
+if engine.v1Buffer.count < engine.v1Buffer.nEntries
+    return
+end
+[pop, ind] = shOnlineRingStack(engine.v1Buffer, engine.v1Size);
+
+if strcmp(engine.stageName, 'v1complex')
+    if hasRes
+        [pop, ind, nume, deno, res, resnume, resdeno] = shModelV1Normalization(pop, ind, pars, resNeurons);
+        varargout = {pop, ind, res, nume, deno, resnume, resdeno};
+    else
+        [pop, ind, nume, deno] = shModelV1Normalization(pop, ind, pars);
+        varargout = {pop, ind, nume, deno};
+    end
+    return
+end
+[pop, ind] = shModelV1Normalization(pop, ind, pars);
+
+% Stage 3: the MT stages that work within a frame.
+if hasRes
+    [pop, ind, res] = shModelMtLinear(pop, ind, pars, resNeurons);
+    [pop, ind, res] = shModelMtPreThresholdBlur(pop, ind, pars, res);
+    [pop, ind, res] = shModelHalfWaveRectification(pop, ind, pars, res);
+    [pop, ind, res] = shModelMtPostThresholdBlur(pop, ind, pars, res);
+    engine = shOnlineRingPush(engine, 'mtResBuffer', res);
+else
+    [pop, ind] = shModelMtLinear(pop, ind, pars);
+    [pop, ind] = shModelMtPreThresholdBlur(pop, ind, pars);
+    [pop, ind] = shModelHalfWaveRectification(pop, ind, pars);
+    [pop, ind] = shModelMtPostThresholdBlur(pop, ind, pars);
+end
+
+% Stage 4: MT normalization over the buffered MT responses.
+engine = shOnlineRingPush(engine, 'mtBuffer', pop);
+if engine.mtBuffer.count < engine.mtBuffer.nEntries
+    return
+end
+[pop, ind] = shOnlineRingStack(engine.mtBuffer, engine.mtSize);
+
+if hasRes
+    res = shOnlineRingStack(engine.mtResBuffer, engine.mtSize);
+    [pop, ind, nume, deno, res, resnume, resdeno] = shModelMtNormalization(pop, ind, pars, res, resNeurons);
+    varargout = {pop, ind, res, nume, deno, resnume, resdeno};
+else
+    [pop, ind, nume, deno] = shModelMtNormalization(pop, ind, pars);
+    varargout = {pop, ind, nume, deno};
+end
+
+
+
+% write the newest entry into its slot of engine.(name) and into the
+% mirror of that slot, so the last nEntries entries always lie next to each
+% other in the data. Only the slots are written: the engine is passed in
+% and out under the same name, so the buffer is not copied.
+function engine = shOnlineRingPush(engine, name, entry)
+
+n = engine.(name).nEntries;
+next = engine.(name).next;
+if engine.(name).stackRows
+    r = size(entry, 1);
+    rows = (next - 1)*r + (1:r);
+    engine.(name).data(rows, :) = entry;
+    engine.(name).data(rows + n*r, :) = entry;
+else
+    engine.(name).data(:, :, next) = entry;
+    engine.(name).data(:, :, next + n) = entry;
+end
+engine.(name).next = mod(next, n) + 1;
+engine.(name).count = min(engine.(name).count + 1, n);
+
+
+
+% the buffered entries, oldest first, as one contiguous block of the data:
+% the frames of a volume, or the stacked rows of a response matrix. Only
+% valid once the buffer is full, when buffer.next is the oldest entry.
+function window = shOnlineRingWindow(buffer)
+
+n = buffer.nEntries;
+if buffer.stackRows
+    r = size(buffer.data, 1) / (2*n);
+    window = buffer.data((buffer.next - 1)*r + 1:(buffer.next - 1 + n)*r, :);
+else
+    window = buffer.data(:, :, buffer.next:buffer.next + n - 1);
+end
+
+
+
+% the buffered responses, oldest first, as a standard shModel response
+% matrix and its IND.
+function [pop, ind] = shOnlineRingStack(buffer, spatialSize)
+
+pop = shOnlineRingWindow(buffer);
+ind = [0 0 0 0; size(pop, 1), spatialSize(1), spatialSize(2), buffer.nEntries];
@@ -0,0 +1,74 @@
+% session = shSessionInit(stageName, additionalNeurons, outputSpec)
+%
+% Set up a model session that recomputes only what has changed.
+%
+% Fitting the model usually means calling shModel over and over on the
+% same stimulus while changing a few parameters, most often ones that only
+% MT reads (pars.mtC50, pars.mtExponent, pars.mtSpatialPoolingFilter, ...).
+% shModel recomputes everything from the stimulus each time. A session
+% instead keeps the output of every stage from the previous call. Each
+% call to shSessionRun compares the new stimulus and pars with the previous
+% ones, looks up the earliest stage that reads any changed field of pars
+% (see shParsDependencies) and reruns the model from that stage on. A
+% sweep over MT parameters therefore only costs the MT stages.
+%
+% Note that pars.mtBaseline acts on the model only through pars.mtAlpha
+% and the scale factors, so after changing it (or pars.v1C50 and
+% pars.mtC50) call shParsScaleFactors as you would for shModel.
+%
+% Required arguments:
+% stageName         the stage of the model whose output you want computed,
+%                   as for shModel.
+%
+% Optional arguments:
+% additionalNeurons tuning of additional neurons not in the population, in
+%                   the same format as for shModel. DEFAULT = [] (none).
+% outputSpec        the reduction applied to the response outputs, as for
+%                   shModel. DEFAULT = 'full'.
+%
+% Output:
+% session           a structure holding the settings and, once it has
+%                   been run, the cached stage outputs. Pass it to
+%                   shSessionRun.
+%
+% Example of use:
+% pars = shPars;
+% s = mkDots(shGetDims(pars, 'mtPattern', [1 1 31]), 0, 1);
+% session = shSessionInit('mtPattern', [0 1]);
+% for c50 = [.05 .1 .2]
+%     pars.mtC50 = c50;
+%     [session, pop, ind, res] = shSessionRun(session, s, pars);
+% end
+%
+% SEE ALSO: shSessionRun, shModel, shParsDependencies
+
+function session = shSessionInit(varargin)
+
+additionalNeurons = 'default';
+outputSpec = 'default';
+
+                    stageName = varargin{1};
+if nargin >= 2;     additionalNeurons = varargin{2};        end
+if nargin >= 3;     outputSpec = varargin{3};               end
+
+if strcmp(additionalNeurons, 'default');    additionalNeurons = [];         end
+if strcmp(outputSpec, 'default');           outputSpec = 'full';            end
+
+% DONE PARSING INPUTS
+
+session.stageName = stageName;
+session.additionalNeurons = additionalNeurons;
+session.outputSpec = outputSpec;
+session.stages = shModelStageList(stageName);
+
+% the stages from which the responses of additional neurons are computed,
+% as in shModel.
+steeringStages = {'v1Linear', 'v1LinearRectified', 'v1FullWaveRectification', 'v1Blur', ...
+    'v1Normalization', 'mtLinear'};
+session.firstResStage = find(ismember(session.stages, steeringStages), 1, 'last');
+
+% filled in by shSessionRun
+session.stimulus = [];
+session.pars = [];
+session.cache = cell(1, length(session.stages));
+session.lastFirstStage = [];
@@ -0,0 +1,124 @@
+% [session, pop, ind, ...] = shSessionRun(session, stimulus, pars)
+%
+% Run the model for a session created by shSessionInit, recomputing only
+% the stages affected by what changed since the previous call.
+%
+% If the stimulus differs from the previous call, every stage is rerun.
+% Otherwise each field of pars that differs from the previous call is
+% looked up in shParsDependencies and the model is rerun from the earliest
+% stage that reads any of them; the outputs of the stages before it are
+% taken from the session. Fields that shParsDependencies does not list are
+% assumed to be read by the first stage. If nothing changed, the cached
+% outputs are returned without running anything.
+%
+% Required arguments:
+% session           the SESSION structure returned by shSessionInit or by a
+%                   previous call to shSessionRun.
+% stimulus          a 3D matrix that contains a stimulus. Its dimensions
+%                   must be [Y X T].
+% pars              a parameters structure like the default parameter
+%                   structure generated by shPars.
+%
+% Output:
+% session           the updated session. Pass it to the next call.
+% pop, ind, ...     the same outputs as shModel(stimulus, pars,
+%                   session.stageName, session.additionalNeurons,
+%                   session.outputSpec), in the same order.
+%
+% The index of the first stage that was rerun is stored in
+% session.lastFirstStage (length(session.stages) + 1 if none was).
+%
+% SEE ALSO: shSessionInit, shModel, shParsDependencies
+
+function [session, varargout] = shSessionRun(session, stimulus, pars)
+
+stages = session.stages;
+nStages = length(stages);
+hasRes = ~isempty(session.additionalNeurons);
+
+if isempty(session.pars) || ~isequal(size(stimulus), size(session.stimulus)) ...
+        || ~isequal(stimulus, session.stimulus)
+    sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
+    if any(sSz < shGetDims(pars, session.stageName))
+        error(['Stimulus is not large enough for computation of the ', ...
+            session.stageName, ' stage.']);
+    end
+    firstStage = 1;
+else
+    firstStage = shSessionFirstAffectedStage(stages, session.pars, pars);
+end
+
+if firstStage == 1
+    pop = stimulus;
+    ind = [];
+    res = [];
+else
+    previous = session.cache{firstStage - 1};
+    pop = previous.pop;
+    ind = previous.ind;
+    res = previous.res;
+    aux = previous.aux;
+end
+
+for i = firstStage:nStages
+    computeRes = hasRes && i >= session.firstResStage;
+    stageSpec = 'full';
+    if i == nStages
+        stageSpec = session.outputSpec;
+    end
+    [pop, ind, res, aux] = shModelRunStage(stages{i}, pop, ind, pars, res, ...
+        session.additionalNeurons, computeRes, stageSpec);
+    session.cache{i} = struct('pop', pop, 'ind', ind, 'res', res, 'aux', aux);
+end
+
+session.stimulus = stimulus;
+session.pars = pars;
+session.lastFirstStage = firstStage;
+
+varargout = shModelPackOutputs(stages{end}, pop, ind, res, aux, hasRes, session.outputSpec);
+
+
+
+% the index in stages of the earliest stage that reads a field that differs
+% between oldPars and newPars, or length(stages) + 1 if no stage does.
+function firstStage = shSessionFirstAffectedStage(stages, oldPars, newPars)
+
+[oldNames, oldValues] = shSessionFlattenPars(oldPars);
+[newNames, newValues] = shSessionFlattenPars(newPars);
+deps = shParsDependencies;
+
+changed = setxor(oldNames, newNames);
+[common, iOld, iNew] = intersect(oldNames, newNames);
+for k = 1:length(common)
+    if ~isequal(oldValues{iOld(k)}, newValues{iNew(k)})
+        changed{end+1} = common{k};
+    end
+end
+
+firstStage = length(stages) + 1;
+for k = 1:length(changed)
+    d = find(strcmp(changed{k}, deps(:, 1)));
+    if isempty(d)
+        firstStage = 1;
+        return
+    end
+    readers = find(ismember(stages, deps{d, 2}), 1);
+    if ~isempty(readers)
+        firstStage = min(firstStage, readers);
+    end
+end
+
+
+
+% the fields of pars, with the subfields of pars.scaleFactors listed
+% separately as 'scaleFactors.<name>'.
+function [names, values] = shSessionFlattenPars(pars)
+
+names = fieldnames(pars)';
+values = struct2cell(pars)';
+w = strcmp(names, 'scaleFactors');
+if any(w)
+    scaleFactors = values{w};
+    names = [names(~w), strcat('scaleFactors.', fieldnames(scaleFactors)')];
+    values = [values(~w), struct2cell(scaleFactors)'];
+end
@@ -1,5 +1,5 @@
 % [populationResponse, v1Directions] = shV1PopulationResponse(stimulus, pars,
-%                                   stageName, nAngles, whichComponent, nAtATime)
+%                       stageName, nAngles, whichComponent, nAtATime, memoryBudget)
 %
 % Compute the response of a large population of V1 neurons to a stimulus.
 %
@@ -18,9 +18,12 @@
 %                   normalization signal. Choices: 'res', 'nume', 'deno'. 
 %                   'nume' and 'deno' only work if stageName = 'v1Complex'.
 %                   DEFAULT = 'res'
-% nAtATime          the number of responses to compute in each batch. If
-%                   this function makes MATLAB run out of memory, reduce
-%                   nAtATime. DEFAULT = 1000;
+% nAtATime          the number of responses to compute in each batch.
+%                   DEFAULT = as many as fit in memoryBudget (see
+%                   shModelPlan).
+% memoryBudget      the number of bytes the model may use at once, used to
+%                   choose nAtATime. If this function makes MATLAB run out
+%                   of memory, reduce it. DEFAULT = 2^28 (256 MB).
 %
 % Output:
 % populationResponse    a vector containing the average response of each
@@ -49,6 +52,7 @@ stageName = 'default';
 nAngles = 'default';
 whichComponent = 'default';
 nAtATime = 'default';
+memoryBudget = 'default';
 
                         stimulus = varargin{1};
                         pars = varargin{2};
@@ -56,11 +60,12 @@ if nargin >= 3;         stageName = varargin{3};            end;
 if nargin >= 4;         nAngles = varargin{4};              end;
 if nargin >= 5;         whichComponent = varargin{5};       end;
 if nargin >= 6;         nAtATime = varargin{6};             end;
+if nargin >= 7;         memoryBudget = varargin{7};         end;
 
 if strcmp(stageName, 'default');        stageName = 'v1Complex';        end;
 if strcmp(nAngles, 'default');          nAngles = 20;                   end;
 if strcmp(whichComponent, 'default');   whichComponent = 'res';         end;
-if strcmp(nAtATime, 'default')'         nAtATime = 1000;                end;
+if strcmp(memoryBudget, 'default');     memoryBudget = 2^28;            end;
 
 %%%% DONE PARSING ARGUMENTS
 
@@ -77,35 +82,92 @@ for j = 1:nphi
     v1Directions = [v1Directions; [v1az, tan(v1el)]];
 end
 
-res = zeros(size(v1Directions, 1), 1);
+% The V1 filters are odd-order directional derivatives, so the linear
+% response of a neuron is the negative of the response of the neuron
+% pointing the opposite way in Fourier space. After full-wave rectification
+% (and the blur and untuned normalization that follow it) the two are
+% identical, so for those stages only one neuron of each antipodal pair is
+% computed and its response is copied to the other. The half-wave
+% rectified stages tell the two apart.
+if any(strcmpi(stageName, {'v1lin', 'v1fullrect', 'v1blur', 'v1complex'}))
+    [computeDirections, mirror] = shV1AntipodalPairs(v1Directions);
+else
+    computeDirections = v1Directions;
+    mirror = (1:size(v1Directions, 1))';
+end
+
+if strcmp(nAtATime, 'default')
+    sSz = [size(stimulus, 1), size(stimulus, 2), size(stimulus, 3)];
+    [plan, nAtATime] = shModelPlan(sSz, pars, stageName, size(computeDirections, 1), memoryBudget);
+end
+
+res = zeros(size(computeDirections, 1), 1);
 i = 0;
-while i < size(v1Directions, 1)
+while i < size(computeDirections, 1)
     startPoint = i+1;
-    endPoint = min(i+nAtATime, size(v1Directions, 1));
-    v1sThisTime = v1Directions(startPoint:endPoint, :);
+    endPoint = min(i+nAtATime, size(computeDirections, 1));
+    v1sThisTime = computeDirections(startPoint:endPoint, :);
 
-    if strcmp(stageName, 'v1complex');
-        [pop, ind, res, nume, deno, resnume, resdeno] = shModel(stimulus, pars, stageName, v1sThisTime);
-    elseif strcmp(stageName, 'v1simple');
-        [pop, ind, res, nume, deno, resnume, resdeno] = shModel(stimulus, pars, stageName, v1sThisTime);
+    % only a summary of the center neuron is kept, so ask shModel for just
+    % that instead of the full response maps. The linear stage has to be
+    % rectified before it is averaged, so it gets the full maps.
+    outputSpec = 'centerMean';
+    if strcmp(whichComponent, 'deno')
+        outputSpec = 'centerMax';
+    end
+    if strcmpi(stageName, 'v1lin')
+        outputSpec = 'full';
+    end
+
+    if strcmpi(stageName, 'v1complex');
+        [pop, ind, res, nume, deno, resnume, resdeno] = shModel(stimulus, pars, stageName, v1sThisTime, outputSpec);
+    elseif strcmpi(stageName, 'v1simple');
+        [pop, ind, res, nume, deno, resnume, resdeno] = shModel(stimulus, pars, stageName, v1sThisTime, outputSpec);
     else
-        [pop, ind, res] = shModel(stimulus, pars, stageName, v1sThisTime);
+        [pop, ind, res] = shModel(stimulus, pars, stageName, v1sThisTime, outputSpec);
     end
 
-    if strcmp(stageName, 'v1lin')
-        res = sqrt(res.^2);
+    if strcmpi(stageName, 'v1lin')
+        res = shReduceResponse(sqrt(res.^2), ind, 'centerMean');
     end
 
     if strcmp(whichComponent, 'nume')
-        populationResponse = mean(shGetNeuron(resnume, ind), 2);
+        populationResponse = resnume';
     elseif strcmp(whichComponent, 'deno')
-        populationResponse = max(shGetNeuron(resdeno, ind), [], 2);
+        populationResponse = resdeno';
     else
-        populationResponse = mean(shGetNeuron(res, ind), 2);
+        populationResponse = res';
     end
     
     rAll(startPoint:endPoint, 1) = populationResponse;
     i = i+nAtATime;
 end
 
-populationResponse = rAll;
\ No newline at end of file
+populationResponse = rAll(mirror);
+
+
+
+% keep one neuron of each antipodal pair in directions. computeDirections
+% holds the neurons to compute, and directions(k,:) has the same response
+% as computeDirections(mirror(k),:).
+function [computeDirections, mirror] = shV1AntipodalPairs(directions)
+
+n = size(directions, 1);
+vec = sphere2rec([directions(:,1), atan(directions(:,2))]);
+
+% the antipode of each direction is the direction nearest to -vec, if it
+% is near enough. Directions that come out of trig functions differ in the
+% last bits, so they are matched with a tolerance rather than exactly.
+antipode = zeros(n, 1);
+for k = 1:n
+    [distance, nearest] = min(sum(bsxfun(@plus, vec, vec(k, :)).^2, 2));
+    if sqrt(distance) < 1e-6
+        antipode(k) = nearest;
+    end
+end
+isPaired = antipode > 0;
+
+representative = (1:n)';
+representative(isPaired) = min(representative(isPaired), antipode(isPaired));
+[keep, first, mirror] = unique(representative);
+computeDirections = directions(keep, :);
\ No newline at end of file
@@ -95,8 +95,8 @@ for i = 1:length(xSpeed)
     
 %     keyboard
     
-    % Compute the neuron's response to this stimulus
-    [pop, ind, res] = shModel(thisStim, pars, stageName, neuron);
+    % Compute the response of the neuron at the center of the stimulus
+    [pop, ind, res] = shModelAtPositions(thisStim, pars, stageName, [0 0], neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
@@ -70,22 +70,29 @@ stimSz = shGetDims(pars, stageName, [1 1 nFrames]);
 xCoherence = linspace(-(nDataPoints-1), 0, nDataPoints);
 xCoherence = 2.^xCoherence;
 yResponse = zeros(1, length(xCoherence));
-for i = 1:length(xCoherence)
-
-    % make stimulus
-    s = mkDots(stimSz, dotDirection, dotSpeed, dotDensity, xCoherence(i), ...
-                dotRadius, dotPlacementStyle);
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xCoherence)
+    batch = first:min(first+nAtATime-1, length(xCoherence));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisStimulus = mkDots(stimSz, dotDirection, dotSpeed, dotDensity, xCoherence(i), ...
+                    dotRadius, dotPlacementStyle);
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % calculate cell's response
-    [pop, ind, res] = shModel(s, pars, stageName, neuron);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
+    end
 
     % display results so far
     plot(xCoherence(1:i), yResponse(1:i), 'r-', xCoherence(1:i), yResponse(1:i), 'k.');
     xlabel('Stimulus coherence'); ylabel('response');
     axis([min(xCoherence) max(xCoherence) min([0, yResponse]), max(1.2*max(yResponse), .00001)]);
     drawnow
-end
\ No newline at end of file
+end
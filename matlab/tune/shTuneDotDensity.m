@@ -70,21 +70,29 @@ stimSz = shGetDims(pars, stageName, [1 1 nFrames]);
 xDensity = linspace(-7, -1, nDataPoints);
 xDensity = 2.^xDensity;
 yResponse = zeros(1, length(xDensity));
-for i = 1:length(xDensity)
-    % generate the stimulus
-    s = mkDots(stimSz, dotDirection, dotSpeed, xDensity(i), dotCoherence, ...
-        dotRadius, dotPlacementStyle);
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xDensity)
+    batch = first:min(first+nAtATime-1, length(xDensity));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisStimulus = mkDots(stimSz, dotDirection, dotSpeed, xDensity(i), dotCoherence, ...
+            dotRadius, dotPlacementStyle);
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % find the neuron's response to the stimulus
-    [pop, ind, res] = shModel(s, pars, stageName, neuron);
-    if strcmp(stageName, 'v1lin');
-        tmp = sqrt(tmp.^2);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
+    if strcmp(stageName, 'v1lin')
+        res = sqrt(res.^2);
+    end
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
 
     % plot the results so far
     plot(xDensity(1:i), yResponse(1:i), 'r-', xDensity(1:i), yResponse(1:i), 'k.');
     xlabel('Dot density'); ylabel('response');
     axis([min(xDensity) max(xDensity) min([0, yResponse]), max(1.2*max(yResponse), .00001)]);
     drawnow
-end
\ No newline at end of file
+end
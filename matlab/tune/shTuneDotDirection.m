@@ -30,6 +30,15 @@
 %                   dotRadius are used. DEFAULT = -1.
 % dotPlacementStyle see documentation in mkDots for explanation. DEFAULT =
 %                   'exact'
+% method            how to compute the curve. 'brute' runs the model on a
+%                   stimulus moving in every direction. 'steer' runs it once,
+%                   on a stimulus moving in the neuron's preferred direction,
+%                   and steers the neuron through the directions instead
+%                   (see shTuneDirectionCurve). 'check' does both, plots the
+%                   brute-force curve dashed, and stops with an error if
+%                   the steered curve, an approximation, is off by more
+%                   than 5% of the peak response.
+%                   DEFAULT = 'brute'.
 
 function [xDirection, yResponse] = shTuneDotDirection(varargin);
 
@@ -41,6 +50,7 @@ dotDensity = 'default';
 dotCoherence = 'default';
 dotRadius = 'default';
 dotPlacementStyle = 'default';
+method = 'default';
 
 % Parse arguments out of varargin
                     pars = varargin{1};
@@ -53,6 +63,7 @@ if nargin >= 7;     dotDensity = varargin{7};           end
 if nargin >= 8;     dotCoherence = varargin{8};         end
 if nargin >= 9;     dotRadius = varargin{9};            end
 if nargin >= 10;    dotPlacementStyle = varargin{10};   end
+if nargin >= 11;    method = varargin{11};              end
 
 % Assign default values
 if strcmp(nDataPoints, 'default');          nDataPoints = 9;                end
@@ -62,28 +73,23 @@ if strcmp(dotDensity, 'default');           dotDensity = 'default';         end
 if strcmp(dotCoherence, 'default');         dotCoherence = 1;               end
 if strcmp(dotRadius, 'default');            dotRadius = -1;                 end
 if strcmp(dotPlacementStyle, 'default');    dotPlacementStyle = 'exact';    end
+if strcmp(method, 'default');               method = 'brute';               end
 
 % We're done parsing arguments. Now on with the code.
 stimSz = shGetDims(pars, stageName, [1 1 nFrames]);
 xDirection = linspace(neuron(1) - pi, neuron(1) + pi, nDataPoints+1);
 xDirection = unique(sort(mod(xDirection, 2*pi)));
 yResponse = zeros(1, length(xDirection));
-for i = 1:length(xDirection)
+makeStimulus = @(direction) mkDots(stimSz, direction, dotSpeed, dotDensity, ...
+                                     dotCoherence, dotRadius, dotPlacementStyle);
+[yResponse, yBrute] = shTuneDirectionCurve(makeStimulus, pars, stageName, neuron, ...
+    xDirection, method);
 
-    % make the stimulus
-    s = mkDots(stimSz, xDirection(i), dotSpeed, dotDensity, dotCoherence, ...
-        dotRadius, dotPlacementStyle);
-
-    % calculate the neuron's response
-    [pop, ind, res] = shModel(s, pars, stageName, neuron);
-    if strcmp(stageName, 'v1lin')
-        res = sqrt(res.^2);
-    end
-    yResponse(i) = mean2(shGetNeuron(res, ind, 1, 1));
-
-    % plot the results so far
-    plot(180*xDirection(1:i)/pi, yResponse(1:i), 'r-', 180*xDirection(1:i)/pi, yResponse(1:i), 'k.');
-    xlabel('direction (deg)'); ylabel('response');
-    axis([0 360 min([0, yResponse]), max(.00005, 1.2*max(yResponse))]);
-    drawnow
-end
\ No newline at end of file
+% plot the results
+plot(180*xDirection/pi, yResponse, 'r-', 180*xDirection/pi, yResponse, 'k.');
+if strcmp(method, 'check')
+    hold on; plot(180*xDirection/pi, yBrute, 'b--'); hold off;
+end
+xlabel('direction (deg)'); ylabel('response');
+axis([0 360 min([0, yResponse]), max(.00005, 1.2*max(yResponse))]);
+drawnow
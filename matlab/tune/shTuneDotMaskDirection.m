@@ -90,20 +90,28 @@ dims = shGetDims(pars, stageName, [1 1 nFrames]);
 xDirection = linspace(neuron(1) - pi, neuron(1) + pi, reso);
 xDirection = unique(sort(mod(xDirection, 2*pi)));
 yResponse = zeros(1, length(xDirection));
-for i = 1:length(xDirection)  
-    % make the stimulus
-    s1 = mkDots(dims, neuron(1), dotSpeed, dotDensity, dotCoherence, dotSize);
-    s2 = mkDots(dims, xDirection(i), dotSpeed, dotDensity, dotCoherence, dotSize);
-    s = s1 + s2;
-    s(s>1) = 1;
-    
-    % get the neuron's average response to the stimulus
-    [pop, ind, res] = shModel(s, pars, stageName, neuron);
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(dims, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xDirection)
+    batch = first:min(first+nAtATime-1, length(xDirection));
+    stimuli = zeros([dims, length(batch)]);
+    for i = batch
+        s1 = mkDots(dims, neuron(1), dotSpeed, dotDensity, dotCoherence, dotSize);
+        s2 = mkDots(dims, xDirection(i), dotSpeed, dotDensity, dotCoherence, dotSize);
+        thisStimulus = s1 + s2;
+        thisStimulus(thisStimulus>1) = 1;
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
+
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
-    
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
+    end
+
     % plot the response so far
     plot(180*xDirection(1:i)/pi, yResponse(1:i), 'r-', 180*xDirection(1:i)/pi, yResponse(1:i), 'k.');
     xlabel('direction (deg)'); ylabel('response');
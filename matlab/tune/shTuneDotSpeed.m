@@ -87,8 +87,8 @@ for i = 1:length(xSpeed)
 %     s = fftshift(ifftn(ifftshift(f)));
 %     s = real(s);
 
-    % get the neuron's response to the stimulus
-    [pop, ind, res] = shModel(s, pars, stageName, neuron);
+    % get the response of the neuron at the center of the stimulus
+    [pop, ind, res] = shModelAtPositions(s, pars, stageName, [0 0], neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
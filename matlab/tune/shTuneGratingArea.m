@@ -71,23 +71,30 @@ if strcmp(gratingContrast, 'default');      gratingContrast = 1;
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xRadius = linspace(minRadius, maxRadius, nDataPoints);
 yResponse = zeros(length(xRadius), 1);
-for i = 1:length(xRadius)
-
-    % Make the stimulus
-    stimulusGrating = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
-                            gratingContrast);
-    windowEdgeWidth = 2;
-    stimulusWindow = mkWin(stimSz, xRadius(i), windowEdgeWidth);
-    thisStimulus = stimulusGrating .* stimulusWindow;
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xRadius)
+    batch = first:min(first+nAtATime-1, length(xRadius));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        stimulusGrating = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
+                                gratingContrast);
+        windowEdgeWidth = 2;
+        stimulusWindow = mkWin(stimSz, xRadius(i), windowEdgeWidth);
+        thisStimulus = stimulusGrating .* stimulusWindow;
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % Calculate the neuron's response to this stimulus
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
+    end
 
     % Plot the results so far.
-    yResponse(i) = mean(shGetNeuron(res, ind));
     plot(xRadius(1:i), yResponse(1:i), 'r-', xRadius(1:i), yResponse(1:i), 'k.');
     xlabel('radius (px)'); ylabel('response');
     axis([0, xRadius(end), 0, 1.2.*max(yResponse)]);
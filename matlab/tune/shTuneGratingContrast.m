@@ -57,18 +57,25 @@ if strcmp(gratingTf, 'default');            gratingTf = preferredGrating(3);
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xContrast = logspace(-2, 0, nDataPoints);
 yResponse = zeros(size(xContrast));
-for i = 1:length(xContrast)
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xContrast)
+    batch = first:min(first+nAtATime-1, length(xContrast));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisStimulus = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
+                             xContrast(i));
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % generate the stimulus    
-    thisStimulus = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
-                         xContrast(i));
-    
-    % get the neuron's response to this stimulus
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
+    end
 
     % plot the response so far
     semilogx(xContrast(1:i), yResponse(1:i), 'r-', xContrast(1:i), yResponse(1:i), 'k.');
@@ -1,5 +1,6 @@
 % [xDirection, yResponse] = shTuneGratingDirection(pars, neuron, stageName, 
-%                           nDataPoints, gratingSf, gratingTf, gratingContrast)
+%                           nDataPoints, gratingSf, gratingTf, gratingContrast,
+%                           method)
 %
 % shTuneGratingDirection computes a tuning curve of response vs. direction 
 % for a full field drifting grating.
@@ -23,6 +24,15 @@
 %                   DEFAULT = the neuron's preferred temporal
 %                   frequency.
 % gratingContrast   the contrast of the grating. DEFAULT = 1
+% method            how to compute the curve. 'brute' runs the model on a
+%                   stimulus moving in every direction. 'steer' runs it once,
+%                   on a stimulus moving in the neuron's preferred direction,
+%                   and steers the neuron through the directions instead
+%                   (see shTuneDirectionCurve). 'check' does both, plots the
+%                   brute-force curve dashed, and stops with an error if
+%                   the steered curve, an approximation, is off by more
+%                   than 5% of the peak response.
+%                   DEFAULT = 'brute'.
 
 
 function [xDirection, yResponse] = shTuneGratingDirection(varargin)
@@ -32,6 +42,7 @@ nDataPoints = 'default';
 gratingSf = 'default';
 gratingTf = 'default';
 gratingContrast = 'default';
+method = 'default';
 
 % parse the varargin
                     pars = varargin{1};
@@ -41,6 +52,7 @@ if nargin >= 4;     nDataPoints = varargin{4};              end
 if nargin >= 5;     gratingSf = varargin{5};                end
 if nargin >= 6;     gratingTf = varargin{6};                end
 if nargin >= 7;     gratingContrast = varargin{7};          end
+if nargin >= 8;     method = varargin{8};                   end
 
 if strcmp(stageName(1:2), 'v1');
     preferredGrating = v12sin(neuron);
@@ -53,27 +65,22 @@ if strcmp(nDataPoints, 'default');          nDataPoints = 7;
 if strcmp(gratingSf, 'default');            gratingSf = preferredGrating(2);        end
 if strcmp(gratingTf, 'default');            gratingTf = preferredGrating(3);        end
 if strcmp(gratingContrast, 'default');      gratingContrast = 1;                    end
+if strcmp(method, 'default');               method = 'brute';                       end
 
 % Done parsing arguments. Now on with the code.
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xDirection = linspace(0, 2.*pi, nDataPoints);
 yResponse = zeros(1, length(xDirection));
-for i = 1:length(xDirection)
+makeStimulus = @(direction) mkSin(stimSz, direction, gratingSf, gratingTf, ...
+                                     gratingContrast);
+[yResponse, yBrute] = shTuneDirectionCurve(makeStimulus, pars, stageName, neuron, ...
+    xDirection, method);
 
-    % Make the stimulus
-    thisStimulus = mkSin(stimSz, xDirection(i), gratingSf, gratingTf, ...
-                         gratingContrast);
-    
-    % get the neuron's response to this stimulus
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
-    if strcmp(stageName, 'v1lin')
-        res = sqrt(res.^2);
-    end
-    yResponse(i) = mean(shGetNeuron(res, ind));
-
-    % plot the results so far
-    plot(180*xDirection(1:i)/pi, yResponse(1:i), 'r-', 180*xDirection(1:i)/pi, yResponse(1:i), 'k.');
-    xlabel('direction (deg)'); ylabel('response');
-    axis([0 360 min([0, yResponse]), max(.00001, 1.2*max(yResponse))]);
-    drawnow
+% plot the results
+plot(180*xDirection/pi, yResponse, 'r-', 180*xDirection/pi, yResponse, 'k.');
+if strcmp(method, 'check')
+    hold on; plot(180*xDirection/pi, yBrute, 'b--'); hold off;
 end
+xlabel('direction (deg)'); ylabel('response');
+axis([0 360 min([0, yResponse]), max(.00001, 1.2*max(yResponse))]);
+drawnow
@@ -67,22 +67,29 @@ if strcmp(stimulusContrast, 'default');     stimulusContrast = 1;
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xMaskDirection = linspace(0, 2*pi, nDataPoints);
 yResponse = zeros(1, length(xMaskDirection));
-for i = 1:length(xMaskDirection)
-
-    % generate the stimulus
-    thisGrating = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
-                        stimulusContrast/2);
-    thisMaskGrating = mkSin(stimSz, xMaskDirection(i), gratingSf, ...
-                            gratingTf, stimulusContrast/2);
-    thisStimulus = thisGrating + thisMaskGrating;
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xMaskDirection)
+    batch = first:min(first+nAtATime-1, length(xMaskDirection));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisGrating = mkSin(stimSz, gratingDirection, gratingSf, gratingTf, ...
+                            stimulusContrast/2);
+        thisMaskGrating = mkSin(stimSz, xMaskDirection(i), gratingSf, ...
+                                gratingTf, stimulusContrast/2);
+        thisStimulus = thisGrating + thisMaskGrating;
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % Calculate the neuron's response to the stimulus.
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
         res = sqrt(res.^2);
     end
-    yResponse(i) = mean2(shGetNeuron(res, ind, 1, 1));
-    
+    for i = batch
+        yResponse(i) = mean2(shGetNeuron(res(:, :, i-first+1), ind, 1, 1));
+    end
+
     % plot the results so far
     plot(180*xMaskDirection(1:i)/pi, yResponse(1:i), 'r-', 180*xMaskDirection(1:i)/pi, yResponse(1:i), 'k.');
     xlabel('direction (deg)'); ylabel('response');
@@ -58,18 +58,25 @@ if strcmp(gratingContrast, 'default');      gratingContrast = 1;
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xSf = logspace(-2, -.3010, nDataPoints);
 yResponse = zeros(size(xSf));
-for i = 1:length(xSf)
-    
-    % generate the stimulus
-    thisStimulus = mkSin(stimSz, gratingDirection, xSf(i), gratingTf, ...
-                         gratingContrast);
-                     
-    % compute the neuron's response to this stimulus
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xSf)
+    batch = first:min(first+nAtATime-1, length(xSf));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisStimulus = mkSin(stimSz, gratingDirection, xSf(i), gratingTf, ...
+                             gratingContrast);
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
+
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
-        tmp = sqrt(res.^2);
+        res = sqrt(res.^2);
+    end
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
 
     % Plot the results thus far
     semilogx(xSf(1:i), yResponse(1:i), 'r-', xSf(1:i), yResponse(1:i), 'k.');
@@ -59,15 +59,24 @@ if strcmp(gratingContrast, 'default');      gratingContrast = 1;
 stimSz = shGetDims(pars, stageName, [1 1 31]);
 xTf = logspace(-2, -.3010, nDataPoints);
 yResponse = zeros(size(xTf));
-for i = 1:length(xTf)
+% run the stimuli through the model a batch at a time (see shModelBatch),
+% plotting the results so far after each batch.
+nAtATime = shTuneBatchSize(stimSz, pars, stageName, size(neuron, 1));
+for first = 1:nAtATime:length(xTf)
+    batch = first:min(first+nAtATime-1, length(xTf));
+    stimuli = zeros([stimSz, length(batch)]);
+    for i = batch
+        thisStimulus = mkSin(stimSz, gratingDirection, gratingSf, xTf(i), gratingContrast);
+        stimuli(:, :, :, i-first+1) = thisStimulus;
+    end
 
-    % generate this stimulus
-    thisStimulus = mkSin(stimSz, gratingDirection, gratingSf, xTf(i), gratingContrast);
-    [pop, ind, res] = shModel(thisStimulus, pars, stageName, neuron);
+    [pop, ind, res] = shModel(stimuli, pars, stageName, neuron);
     if strcmp(stageName, 'v1lin')
-        tmp = sqrt(res.^2);
+        res = sqrt(res.^2);
+    end
+    for i = batch
+        yResponse(i) = mean(shGetNeuron(res(:, :, i-first+1), ind));
     end
-    yResponse(i) = mean(shGetNeuron(res, ind));
 
     % plot the results thus far
     semilogx(xTf(1:i), yResponse(1:i), 'r-', xTf(1:i), yResponse(1:i), 'k.');
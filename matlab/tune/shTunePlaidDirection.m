@@ -1,6 +1,6 @@
 % [xDirection, yResponse] = shTunePlaidDirection(pars, neuron, stageName, 
 %                           nDataPoints, gratingSf, gratingTf, plaidAngle, 
-%                           plaidContrast)
+%                           plaidContrast, method)
 %
 % shTunePlaidDirection computes a tuning curve of response vs. direction 
 % for a full field drifting plaid.
@@ -27,6 +27,15 @@
 % plaidAngle        the angle between the plaid's component gratings, in
 %                   radians. DEFAULT = (2/3)*pi  (120 degrees).
 % plaidContrast     the contrast of the plaid. DEFAULT = 1
+% method            how to compute the curve. 'brute' runs the model on a
+%                   stimulus moving in every direction. 'steer' runs it once,
+%                   on a stimulus moving in the neuron's preferred direction,
+%                   and steers the neuron through the directions instead
+%                   (see shTuneDirectionCurve). 'check' does both, plots the
+%                   brute-force curve dashed, and stops with an error if
+%                   the steered curve, an approximation, is off by more
+%                   than 5% of the peak response.
+%                   DEFAULT = 'brute'.
 
 function [xDirection, yResponse] = shTunePlaidDirection(varargin)
 
@@ -36,6 +45,7 @@ gratingSf = 'default';
 gratingTf = 'default';
 plaidAngle = 'default';
 plaidContrast = 'default';
+method = 'default';
 
 % parse the varargin
                     pars = varargin{1};
@@ -46,6 +56,7 @@ if nargin >= 5;     gratingSf = varargin{5};                end
 if nargin >= 6;     gratingTf = varargin{6};                end
 if nargin >= 7;     plaidAngle = varargin{7};               end
 if nargin >= 8;     plaidContrast = varargin{8};            end
+if nargin >= 9;     method = varargin{9};                   end
 
 if strcmp(stageName(1:2), 'v1');
     preferredGrating = v12sin(neuron);
@@ -59,26 +70,22 @@ if strcmp(gratingSf, 'default');            gratingSf = preferredGrating(2);
 if strcmp(gratingTf, 'default');            gratingTf = preferredGrating(3);        end
 if strcmp(plaidAngle, 'default');           plaidAngle = (2/3)*pi;                  end
 if strcmp(plaidContrast, 'default');      plaidContrast = 1;                        end
+if strcmp(method, 'default');               method = 'brute';                       end
 
 % done parsing arguments. Now get on with it.
 stimSz = shGetDims(pars, stageName, [1 1 1]);
 xDirection = linspace(0, 2*pi, nDataPoints);
 yResponse = zeros(1, length(xDirection));
-for i = 1:length(xDirection)
+makeStimulus = @(direction) mkPlaid(stimSz, direction, gratingSf, gratingTf, ...
+                                      plaidAngle, plaidContrast);
+[yResponse, yBrute] = shTuneDirectionCurve(makeStimulus, pars, stageName, neuron, ...
+    xDirection, method);
 
-    % generate the stimulus
-    thisPlaid = mkPlaid(stimSz, xDirection(i), gratingSf, gratingTf, plaidAngle, plaidContrast);
-    
-    % compute the neuron's response to this plaid
-    [pop, ind, res] = shModel(thisPlaid, pars, stageName, neuron);
-    if strcmp(stageName, 'v1lin')
-        res = sqrt(res.^2);
-    end
-    yResponse(i) = mean(shGetNeuron(res, ind));
-
-    % plot the results thus far
-    plot(180*xDirection(1:i)/pi, yResponse(1:i), 'k.', 180*xDirection(1:i)/pi, yResponse(1:i), 'r-');
-    xlabel('direction (deg)'); ylabel('response');
-    axis([0 360 min([0, yResponse]) max(.00005, 1.2*max(yResponse))]);
-    drawnow
+% plot the results
+plot(180*xDirection/pi, yResponse, 'k.', 180*xDirection/pi, yResponse, 'r-');
+if strcmp(method, 'check')
+    hold on; plot(180*xDirection/pi, yBrute, 'b--'); hold off;
 end
+xlabel('direction (deg)'); ylabel('response');
+axis([0 360 min([0, yResponse]) max(.00005, 1.2*max(yResponse))]);
+drawnow